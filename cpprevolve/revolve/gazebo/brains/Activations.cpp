@@ -0,0 +1,428 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Batched activation functions with polynomial approximations
+ *              of exp and sin for the neural network brains.
+ * Date: October 16, 2026
+ *
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// The vector kernels are compiled with per-function target attributes, so
+// the rest of the plugin does not need to be built for a specific CPU.
+#if defined(__GNUC__) and (defined(__x86_64__) or defined(__i386__))
+#define REVOLVE_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+#include "Activations.h"
+
+using namespace revolve::gazebo;
+
+/// \brief Taylor coefficients 1/k! of exp, highest degree last
+static const double EXP_COEFFICIENTS[] = {
+    1.0,
+    1.0,
+    1.0 / 2,
+    1.0 / 6,
+    1.0 / 24,
+    1.0 / 120,
+    1.0 / 720,
+    1.0 / 5040,
+    1.0 / 40320,
+    1.0 / 362880,
+    1.0 / 3628800,
+    1.0 / 39916800};
+
+/// \brief Taylor coefficients (-1)^k/(2k+1)! of sin(x)/x in x^2, highest
+/// degree last
+static const double SIN_COEFFICIENTS[] = {
+    1.0,
+    -1.0 / 6,
+    1.0 / 120,
+    -1.0 / 5040,
+    1.0 / 362880,
+    -1.0 / 39916800,
+    1.0 / 6227020800,
+    -1.0 / 1307674368000};
+
+/// \brief Range reduction constants
+static const double LOG2E = 1.4426950408889634;
+static const double LN2_HI = 6.93147180369123816490e-01;
+static const double LN2_LO = 1.90821492927058770002e-10;
+static const double EXP_MIN = -708.0;
+static const double EXP_MAX = 709.0;
+static const double INV_TWO_PI = 0.15915494309189535;
+static const double TWO_PI_HI = 6.283185307179586;
+static const double TWO_PI_LO = 2.4492935982947064e-16;
+static const double HALF_PI = M_PI / 2;
+
+/// \return Degree of the exp polynomial for an accuracy
+static unsigned int ExpDegree(const ActivationAccuracy _accuracy)
+{
+  return _accuracy == ULTRA_FAST ? 5 : 11;
+}
+
+/// \return Number of terms of the sin polynomial for an accuracy
+static unsigned int SinTerms(const ActivationAccuracy _accuracy)
+{
+  return _accuracy == ULTRA_FAST ? 5 : 8;
+}
+
+/////////////////////////////////////////////////
+static double ExpScalar(double _x, const unsigned int _degree)
+{
+  _x = std::fmin(std::fmax(_x, EXP_MIN), EXP_MAX);
+
+  // x = n ln(2) + r, |r| <= ln(2) / 2
+  auto n = std::nearbyint(_x * LOG2E);
+  auto r = (_x - n * LN2_HI) - n * LN2_LO;
+
+  auto p = EXP_COEFFICIENTS[_degree];
+  for (auto k = _degree; k > 0; --k)
+  {
+    p = p * r + EXP_COEFFICIENTS[k - 1];
+  }
+
+  // Multiply by 2^n by building the exponent bits directly
+  auto bits = static_cast< uint64_t >(static_cast< int64_t >(n) + 1023)
+              << 52;
+  double scale;
+  std::memcpy(&scale, &bits, sizeof(scale));
+  return p * scale;
+}
+
+/////////////////////////////////////////////////
+static double SinScalar(const double _x, const unsigned int _terms)
+{
+  // Reduce to [-pi, pi], then fold onto [-pi/2, pi/2]
+  auto k = std::nearbyint(_x * INV_TWO_PI);
+  auto r = (_x - k * TWO_PI_HI) - k * TWO_PI_LO;
+  if (r > HALF_PI)
+  {
+    r = M_PI - r;
+  }
+  else if (r < -HALF_PI)
+  {
+    r = -M_PI - r;
+  }
+
+  auto r2 = r * r;
+  auto p = SIN_COEFFICIENTS[_terms - 1];
+  for (auto t = _terms - 1; t > 0; --t)
+  {
+    p = p * r2 + SIN_COEFFICIENTS[t - 1];
+  }
+  return p * r;
+}
+
+/////////////////////////////////////////////////
+static void ExpBatchScalar(
+    const double *_x,
+    double *_y,
+    const size_t _n,
+    const unsigned int _degree)
+{
+  for (size_t i = 0; i < _n; ++i)
+  {
+    _y[i] = ExpScalar(_x[i], _degree);
+  }
+}
+
+/////////////////////////////////////////////////
+static void SigmoidBatchScalar(
+    const double *_x,
+    double *_y,
+    const size_t _n,
+    const unsigned int _degree)
+{
+  for (size_t i = 0; i < _n; ++i)
+  {
+    _y[i] = 1.0 / (1.0 + ExpScalar(-_x[i], _degree));
+  }
+}
+
+/////////////////////////////////////////////////
+static void SinBatchScalar(
+    const double *_x,
+    double *_y,
+    const size_t _n,
+    const unsigned int _terms)
+{
+  for (size_t i = 0; i < _n; ++i)
+  {
+    _y[i] = SinScalar(_x[i], _terms);
+  }
+}
+
+#ifdef REVOLVE_X86_KERNELS
+/////////////////////////////////////////////////
+__attribute__((target("avx2,fma")))
+static inline __m256d ExpAvx2(__m256d _x, const unsigned int _degree)
+{
+  _x = _mm256_min_pd(_mm256_max_pd(_x, _mm256_set1_pd(EXP_MIN)),
+                     _mm256_set1_pd(EXP_MAX));
+
+  auto n = _mm256_round_pd(
+      _mm256_mul_pd(_x, _mm256_set1_pd(LOG2E)),
+      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  auto r = _mm256_fnmadd_pd(n, _mm256_set1_pd(LN2_HI), _x);
+  r = _mm256_fnmadd_pd(n, _mm256_set1_pd(LN2_LO), r);
+
+  auto p = _mm256_set1_pd(EXP_COEFFICIENTS[_degree]);
+  for (auto k = _degree; k > 0; --k)
+  {
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(EXP_COEFFICIENTS[k - 1]));
+  }
+
+  // Adding 1.5 * 2^52 moves the integer n into the low mantissa bits,
+  // from where it is shifted into the exponent field.
+  auto shifted = _mm256_add_pd(n, _mm256_set1_pd(6755399441055744.0));
+  auto bits = _mm256_slli_epi64(
+      _mm256_add_epi64(_mm256_castpd_si256(shifted),
+                       _mm256_set1_epi64x(1023)),
+      52);
+  return _mm256_mul_pd(p, _mm256_castsi256_pd(bits));
+}
+
+/////////////////////////////////////////////////
+__attribute__((target("avx2,fma")))
+static inline __m256d SinAvx2(const __m256d _x, const unsigned int _terms)
+{
+  auto k = _mm256_round_pd(
+      _mm256_mul_pd(_x, _mm256_set1_pd(INV_TWO_PI)),
+      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  auto r = _mm256_fnmadd_pd(k, _mm256_set1_pd(TWO_PI_HI), _x);
+  r = _mm256_fnmadd_pd(k, _mm256_set1_pd(TWO_PI_LO), r);
+
+  // Fold [pi/2, pi] and [-pi, -pi/2] onto [-pi/2, pi/2]
+  auto pi = _mm256_set1_pd(M_PI);
+  auto halfPi = _mm256_set1_pd(HALF_PI);
+  auto above = _mm256_cmp_pd(r, halfPi, _CMP_GT_OQ);
+  auto below = _mm256_cmp_pd(
+      r, _mm256_sub_pd(_mm256_setzero_pd(), halfPi), _CMP_LT_OQ);
+  r = _mm256_blendv_pd(r, _mm256_sub_pd(pi, r), above);
+  r = _mm256_blendv_pd(
+      r, _mm256_sub_pd(_mm256_sub_pd(_mm256_setzero_pd(), pi), r), below);
+
+  auto r2 = _mm256_mul_pd(r, r);
+  auto p = _mm256_set1_pd(SIN_COEFFICIENTS[_terms - 1]);
+  for (auto t = _terms - 1; t > 0; --t)
+  {
+    p = _mm256_fmadd_pd(p, r2, _mm256_set1_pd(SIN_COEFFICIENTS[t - 1]));
+  }
+  return _mm256_mul_pd(p, r);
+}
+
+/////////////////////////////////////////////////
+__attribute__((target("avx2,fma")))
+static void ExpBatchAvx2(
+    const double *_x,
+    double *_y,
+    const size_t _n,
+    const unsigned int _degree)
+{
+  size_t i = 0;
+  for (; i + 4 <= _n; i += 4)
+  {
+    _mm256_storeu_pd(_y + i, ExpAvx2(_mm256_loadu_pd(_x + i), _degree));
+  }
+  ExpBatchScalar(_x + i, _y + i, _n - i, _degree);
+}
+
+/////////////////////////////////////////////////
+__attribute__((target("avx2,fma")))
+static void SigmoidBatchAvx2(
+    const double *_x,
+    double *_y,
+    const size_t _n,
+    const unsigned int _degree)
+{
+  auto one = _mm256_set1_pd(1.0);
+  size_t i = 0;
+  for (; i + 4 <= _n; i += 4)
+  {
+    auto x = _mm256_sub_pd(_mm256_setzero_pd(), _mm256_loadu_pd(_x + i));
+    auto e = ExpAvx2(x, _degree);
+    _mm256_storeu_pd(_y + i, _mm256_div_pd(one, _mm256_add_pd(one, e)));
+  }
+  SigmoidBatchScalar(_x + i, _y + i, _n - i, _degree);
+}
+
+/////////////////////////////////////////////////
+__attribute__((target("avx2,fma")))
+static void SinBatchAvx2(
+    const double *_x,
+    double *_y,
+    const size_t _n,
+    const unsigned int _terms)
+{
+  size_t i = 0;
+  for (; i + 4 <= _n; i += 4)
+  {
+    _mm256_storeu_pd(_y + i, SinAvx2(_mm256_loadu_pd(_x + i), _terms));
+  }
+  SinBatchScalar(_x + i, _y + i, _n - i, _terms);
+}
+#endif
+
+/// \brief Batch kernel signature, the last argument is the polynomial
+/// degree or number of terms
+typedef void (*BatchKernel)(
+    const double *,
+    double *,
+    const size_t,
+    const unsigned int);
+
+/// \brief Kernels for the instruction set of this CPU
+struct Kernels
+{
+  BatchKernel exp;
+  BatchKernel sigmoid;
+  BatchKernel sin;
+  std::string name;
+};
+
+/////////////////////////////////////////////////
+static const Kernels &BestKernels()
+{
+  static const Kernels kernels = []() -> Kernels
+  {
+#ifdef REVOLVE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma"))
+    {
+      return {ExpBatchAvx2, SigmoidBatchAvx2, SinBatchAvx2, "AVX2"};
+    }
+#endif
+    return {ExpBatchScalar, SigmoidBatchScalar, SinBatchScalar, "scalar"};
+  }();
+  return kernels;
+}
+
+/////////////////////////////////////////////////
+ActivationAccuracy Activations::ParseAccuracy(const std::string &_name)
+{
+  if ("exact" == _name)
+  {
+    return EXACT;
+  }
+  if ("fast" == _name)
+  {
+    return FAST;
+  }
+  if ("ultra_fast" == _name)
+  {
+    return ULTRA_FAST;
+  }
+
+  std::cerr << "Unknown activation accuracy `" << _name
+            << "`, expected `exact`, `fast` or `ultra_fast`." << std::endl;
+  throw std::runtime_error("Robot brain error");
+}
+
+/////////////////////////////////////////////////
+void Activations::Exp(
+    const double *_x,
+    double *_y,
+    const size_t _n,
+    const ActivationAccuracy _accuracy)
+{
+  if (_accuracy == EXACT)
+  {
+    for (size_t i = 0; i < _n; ++i)
+    {
+      _y[i] = std::exp(_x[i]);
+    }
+    return;
+  }
+  BestKernels().exp(_x, _y, _n, ExpDegree(_accuracy));
+}
+
+/////////////////////////////////////////////////
+void Activations::Sigmoid(
+    const double *_x,
+    double *_y,
+    const size_t _n,
+    const ActivationAccuracy _accuracy)
+{
+  if (_accuracy == EXACT)
+  {
+    for (size_t i = 0; i < _n; ++i)
+    {
+      _y[i] = 1.0 / (1.0 + std::exp(-_x[i]));
+    }
+    return;
+  }
+  BestKernels().sigmoid(_x, _y, _n, ExpDegree(_accuracy));
+}
+
+/////////////////////////////////////////////////
+void Activations::Tanh(
+    const double *_x,
+    double *_y,
+    const size_t _n,
+    const ActivationAccuracy _accuracy)
+{
+  if (_accuracy == EXACT)
+  {
+    for (size_t i = 0; i < _n; ++i)
+    {
+      _y[i] = std::tanh(_x[i]);
+    }
+    return;
+  }
+
+  // tanh(x) = 2 * sigmoid(2x) - 1
+  for (size_t i = 0; i < _n; ++i)
+  {
+    _y[i] = 2 * _x[i];
+  }
+  BestKernels().sigmoid(_y, _y, _n, ExpDegree(_accuracy));
+  for (size_t i = 0; i < _n; ++i)
+  {
+    _y[i] = 2 * _y[i] - 1;
+  }
+}
+
+/////////////////////////////////////////////////
+void Activations::Sin(
+    const double *_x,
+    double *_y,
+    const size_t _n,
+    const ActivationAccuracy _accuracy)
+{
+  if (_accuracy == EXACT)
+  {
+    for (size_t i = 0; i < _n; ++i)
+    {
+      _y[i] = std::sin(_x[i]);
+    }
+    return;
+  }
+  BestKernels().sin(_x, _y, _n, SinTerms(_accuracy));
+}
+
+/////////////////////////////////////////////////
+std::string Activations::KernelName()
+{
+  return BestKernels().name;
+}
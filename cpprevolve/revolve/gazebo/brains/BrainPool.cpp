@@ -0,0 +1,623 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: World-scoped pool that evaluates the neural networks of all
+ *              robots sharing a neuron layout as one batch.
+ * Date: October 16, 2026
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "BrainPool.h"
+#include "NeuralNetwork.h"
+#include "../motors/Motor.h"
+
+namespace gz = gazebo;
+
+using namespace revolve::gazebo;
+
+std::map< std::string, std::weak_ptr< BrainPool > > BrainPool::registry_;
+
+boost::mutex BrainPool::registryMutex_;
+
+/////////////////////////////////////////////////
+struct BrainPool::Group
+{
+  /// \brief Per robot bookkeeping
+  struct Lane
+  {
+    /// \brief The network evaluated in this lane
+    NeuralNetwork *network;
+
+    /// \brief Whether the network submitted inputs since the last step
+    bool pending;
+
+    /// \brief Motors to update after the step
+    const std::vector< MotorPtr > *motors;
+
+    /// \brief Robot time of the submission
+    double time;
+
+    /// \brief Actuation time of the submission
+    double step;
+  };
+
+  /// \brief Constructor, takes the layout from the first network
+  explicit Group(const NeuralNetwork *_network);
+
+  /// \return The key of the group a network belongs to
+  static std::vector< unsigned int > Key(const NeuralNetwork *_network);
+
+  /// \brief Makes room for a number of lanes, growing the stride
+  /// geometrically so that appending a lane rarely moves the arrays
+  void Reserve(const unsigned int _lanes);
+
+  /// \brief Copies weights, params and state of a lane's network into the
+  /// lane
+  void Write(const unsigned int _lane);
+
+  /// \brief Copies the state of a lane back into its network
+  void Read(const unsigned int _lane);
+
+  /// \brief Removes a lane by moving the last lane into its place
+  void Erase(const unsigned int _lane);
+
+  /// \brief Steps the networks of all pending lanes
+  void Step();
+
+  /// \brief Sends the outputs of all pending lanes to their motors
+  void Actuate();
+
+  /// \brief Layout shared by all networks in the group
+  unsigned int nInputs;
+  unsigned int nOutputs;
+  unsigned int nNonInputs;
+  unsigned int nColumns;
+  std::vector< unsigned int > types;
+  std::vector< unsigned int > order;
+  bool acyclic;
+  ActivationAccuracy accuracy;
+
+  /// \brief Robots in the group
+  std::vector< Lane > lanes;
+
+  /// \brief Number of lanes the arrays have room for
+  unsigned int stride;
+
+  /// \brief Whether any lane is pending
+  bool pending;
+
+  /// \brief Weights, indexed as `(row * nColumns + column) * stride + lane`
+  std::vector< double > weights;
+
+  /// \brief Params, indexed as `(neuron * MAX_NEURON_PARAMS + i) * stride
+  /// + lane`
+  std::vector< double > params;
+
+  /// \brief Current and next state, indexed as `column * stride + lane`
+  std::vector< double > state;
+  std::vector< double > next;
+
+  /// \brief Weighted input sum per lane
+  std::vector< double > sums;
+
+  /// \brief Robot time per lane
+  std::vector< double > times;
+
+  /// \brief Motor values of one lane
+  std::vector< double > outputs;
+};
+
+/////////////////////////////////////////////////
+std::vector< unsigned int > BrainPool::Group::Key(
+    const NeuralNetwork *_network)
+{
+  const auto &layout = *_network->layout_;
+  std::vector< unsigned int > key = {
+      layout.nInputs,
+      layout.nOutputs,
+      layout.nHidden,
+      layout.acyclic ? 1u : 0u,
+      static_cast< unsigned int >(_network->accuracy_)};
+  key.insert(key.end(), layout.types.begin(), layout.types.end());
+  key.insert(key.end(), layout.order.begin(), layout.order.end());
+  return key;
+}
+
+/////////////////////////////////////////////////
+BrainPool::Group::Group(const NeuralNetwork *_network)
+    : nInputs(_network->layout_->nInputs)
+    , nOutputs(_network->layout_->nOutputs)
+    , nNonInputs(_network->layout_->nNonInputs)
+    , nColumns(_network->layout_->weights.Cols())
+    , types(_network->layout_->types)
+    , order(_network->layout_->order)
+    , acyclic(_network->layout_->acyclic)
+    , accuracy(_network->accuracy_)
+    , stride(0)
+    , pending(false)
+    , outputs(_network->layout_->nOutputs, 0)
+{
+}
+
+/////////////////////////////////////////////////
+void BrainPool::Group::Reserve(const unsigned int _lanes)
+{
+  if (_lanes <= this->stride)
+  {
+    return;
+  }
+
+  const auto grown = std::max(_lanes, 2 * this->stride);
+  const auto numLanes = this->lanes.size();
+  auto restride = [&](std::vector< double > &_array, const size_t _rows)
+  {
+    std::vector< double > array(_rows * grown, 0);
+    for (size_t r = 0; r < _rows; ++r)
+    {
+      auto row = _array.begin() + r * this->stride;
+      std::copy(row, row + numLanes, array.begin() + r * grown);
+    }
+    _array.swap(array);
+  };
+  restride(this->weights, this->nNonInputs * this->nColumns);
+  restride(this->params, this->nNonInputs * MAX_NEURON_PARAMS);
+  restride(this->state, this->nColumns);
+  this->next.assign(this->nColumns * grown, 0);
+  this->sums.assign(grown, 0);
+  this->times.resize(grown);
+  this->stride = grown;
+}
+
+/////////////////////////////////////////////////
+void BrainPool::Group::Write(const unsigned int _lane)
+{
+  const auto S = this->stride;
+  const auto *network = this->lanes[_lane].network;
+  this->times[_lane] = this->lanes[_lane].time;
+
+  // Connections the previous network of the lane had may be gone
+  for (unsigned int k = 0; k < this->nNonInputs * this->nColumns; ++k)
+  {
+    this->weights[k * S + _lane] = 0;
+  }
+
+  const auto &offsets = network->layout_->weights.Offsets();
+  const auto &columns = network->layout_->weights.Columns();
+  const auto &values = network->layout_->weights.Values();
+  for (unsigned int i = 0; i < this->nNonInputs; ++i)
+  {
+    for (auto k = offsets[i]; k < offsets[i + 1]; ++k)
+    {
+      auto index = i * this->nColumns + columns[k];
+      this->weights[index * S + _lane] = values[k];
+    }
+  }
+
+  for (size_t i = 0; i < network->layout_->params.size(); ++i)
+  {
+    this->params[i * S + _lane] = network->layout_->params[i];
+  }
+
+  const auto &current = network->flipState_ ? network->state2_
+                                            : network->state1_;
+  for (unsigned int c = 0; c < this->nColumns; ++c)
+  {
+    this->state[c * S + _lane] = current[c];
+  }
+}
+
+/////////////////////////////////////////////////
+void BrainPool::Group::Read(const unsigned int _lane)
+{
+  auto *network = this->lanes[_lane].network;
+  auto &current = network->flipState_ ? network->state2_
+                                      : network->state1_;
+  for (unsigned int c = 0; c < this->nColumns; ++c)
+  {
+    current[c] = this->state[c * this->stride + _lane];
+  }
+}
+
+/////////////////////////////////////////////////
+void BrainPool::Group::Erase(const unsigned int _lane)
+{
+  const auto S = this->stride;
+  const auto last = static_cast< unsigned int >(this->lanes.size() - 1);
+  if (_lane not_eq last)
+  {
+    auto move = [&](std::vector< double > &_array, const size_t _rows)
+    {
+      for (size_t r = 0; r < _rows; ++r)
+      {
+        _array[r * S + _lane] = _array[r * S + last];
+      }
+    };
+    move(this->weights, this->nNonInputs * this->nColumns);
+    move(this->params, this->nNonInputs * MAX_NEURON_PARAMS);
+    move(this->state, this->nColumns);
+    this->times[_lane] = this->times[last];
+    this->lanes[_lane] = this->lanes[last];
+  }
+  this->lanes.pop_back();
+
+  this->pending = std::any_of(
+      this->lanes.begin(),
+      this->lanes.end(),
+      [](const Lane &_lane) { return _lane.pending; });
+}
+
+/////////////////////////////////////////////////
+void BrainPool::Group::Step()
+{
+  const auto L = static_cast< unsigned int >(this->lanes.size());
+  const auto S = this->stride;
+
+  // Acyclic networks are evaluated in place in topological order, cyclic
+  // ones from the current into the next state.
+  double *cur = this->state.data();
+  double *nxt = this->acyclic ? cur : this->next.data();
+  double *__restrict sums = this->sums.data();
+  const double *__restrict times = this->times.data();
+
+  if (not this->acyclic)
+  {
+    std::copy(cur, cur + this->nInputs * S, nxt);
+  }
+
+  const auto numRows = this->acyclic
+                       ? static_cast< unsigned int >(this->order.size())
+                       : this->nNonInputs;
+  for (unsigned int k = 0; k < numRows; ++k)
+  {
+    const auto i = this->acyclic ? this->order[k] : k;
+
+    // Weighted sums of neuron `i` for all lanes at once
+    std::fill(sums, sums + L, 0.0);
+    const double *__restrict w = &this->weights[i * this->nColumns * S];
+    for (unsigned int c = 0; c < this->nColumns; ++c)
+    {
+      const double *__restrict wc = w + c * S;
+      const double *__restrict sc = cur + c * S;
+      for (unsigned int l = 0; l < L; ++l)
+      {
+        sums[l] += wc[l] * sc[l];
+      }
+    }
+
+    const double *__restrict p = &this->params[i * MAX_NEURON_PARAMS * S];
+    double *out = nxt + (this->nInputs + i) * S;
+    switch (this->types[i])
+    {
+      case SIGMOID:
+        /* params are bias, gain */
+        for (unsigned int l = 0; l < L; ++l)
+        {
+          sums[l] = p[S + l] * (sums[l] - p[l]);
+        }
+        Activations::Sigmoid(sums, out, L, this->accuracy);
+        break;
+      case SIMPLE:
+        /* linear, params are bias, gain */
+        for (unsigned int l = 0; l < L; ++l)
+        {
+          out[l] = p[S + l] * (sums[l] - p[l]);
+        }
+        break;
+      case OSCILLATOR:
+        /* params are period, phase offset, gain (amplitude) */
+        for (unsigned int l = 0; l < L; ++l)
+        {
+          sums[l] = (2.0 * M_PI / p[l]) * (times[l] - p[l] * p[S + l]);
+        }
+        Activations::Sin(sums, sums, L, this->accuracy);
+        for (unsigned int l = 0; l < L; ++l)
+        {
+          auto gain = p[2 * S + l];
+          auto value = (sums[l] + 1.0) / 2.0;
+          out[l] = 0.5 - (gain / 2.0) + value * gain;
+        }
+        break;
+      case INPUT:
+      case CTRNN_SIGMOID:
+      case SUPG:
+      default:
+        std::cerr << "Invalid neuron type during processing, must be a bug."
+                  << std::endl;
+        throw std::runtime_error("Robot brain error");
+    }
+  }
+
+  // Lanes that did not submit this tick keep their state. Acyclic networks
+  // have no state beyond their inputs, so recomputing them is harmless.
+  for (unsigned int l = 0; l < L; ++l)
+  {
+    if (this->lanes[l].pending or this->acyclic)
+    {
+      continue;
+    }
+    for (unsigned int c = 0; c < this->nColumns; ++c)
+    {
+      nxt[c * S + l] = cur[c * S + l];
+    }
+  }
+
+  if (not this->acyclic)
+  {
+    this->state.swap(this->next);
+  }
+}
+
+/////////////////////////////////////////////////
+void BrainPool::Group::Actuate()
+{
+  const auto numLanes = static_cast< unsigned int >(this->lanes.size());
+  for (unsigned int l = 0; l < numLanes; ++l)
+  {
+    auto &lane = this->lanes[l];
+    if (not lane.pending)
+    {
+      continue;
+    }
+    lane.pending = false;
+
+    for (unsigned int o = 0; o < this->nOutputs; ++o)
+    {
+      this->outputs[o] = this->state[(this->nInputs + o) * this->stride + l];
+    }
+
+    unsigned int p = 0;
+    for (const auto &motor : *lane.motors)
+    {
+      motor->Update(&this->outputs[p], lane.step);
+      p += motor->Outputs();
+    }
+  }
+  this->pending = false;
+}
+
+/////////////////////////////////////////////////
+BrainPoolPtr BrainPool::Create(const ::gazebo::physics::WorldPtr &_world)
+{
+  auto name = _world->Name();
+  auto pool = std::make_shared< BrainPool >(name);
+
+  boost::mutex::scoped_lock lock(BrainPool::registryMutex_);
+  BrainPool::registry_[name] = pool;
+
+  std::cout << "Batching robot brains in world `" << name << "`."
+            << std::endl;
+  return pool;
+}
+
+/////////////////////////////////////////////////
+BrainPoolPtr BrainPool::Find(const std::string &_worldName)
+{
+  boost::mutex::scoped_lock lock(BrainPool::registryMutex_);
+  auto iter = BrainPool::registry_.find(_worldName);
+  if (iter == BrainPool::registry_.end())
+  {
+    return nullptr;
+  }
+  return iter->second.lock();
+}
+
+/////////////////////////////////////////////////
+BrainPool::BrainPool(const std::string &_worldName)
+    : worldName_(_worldName)
+{
+  this->updateConnection_ = gz::event::Events::ConnectWorldUpdateEnd(
+      boost::bind(&BrainPool::Flush, this));
+}
+
+/////////////////////////////////////////////////
+BrainPool::~BrainPool()
+{
+  this->updateConnection_.reset();
+
+  boost::mutex::scoped_lock lock(BrainPool::registryMutex_);
+  auto iter = BrainPool::registry_.find(this->worldName_);
+  if (iter not_eq BrainPool::registry_.end() and iter->second.expired())
+  {
+    BrainPool::registry_.erase(iter);
+  }
+}
+
+/////////////////////////////////////////////////
+void BrainPool::Add(NeuralNetwork *_network)
+{
+  // Neurons with their own state and reduced weights are not batched yet,
+  // and the pool does not record traces, such networks are stepped by
+  // themselves
+  const auto &types = _network->layout_->types;
+  auto stateful = std::any_of(types.begin(), types.end(),
+      [](const unsigned int _type)
+      {
+        return _type == CTRNN_SIGMOID or _type == SUPG;
+      });
+  auto excluded = stateful or _network->layout_->useCompact
+                  or _network->recorder_;
+
+  boost::mutex::scoped_lock lock(this->mutex_);
+
+  // A member adopting a new layout already holds its state in that layout,
+  // so its lane is dropped without copying the state back
+  Group *current;
+  unsigned int lane;
+  auto member = this->Locate(_network, current, lane);
+  if (excluded)
+  {
+    if (member)
+    {
+      this->Leave(current, lane);
+    }
+    return;
+  }
+
+  auto key = Group::Key(_network);
+  if (member)
+  {
+    // A new layout with the same key only changes the lane's weights,
+    // params and state
+    auto iter = this->groups_.find(key);
+    if (iter not_eq this->groups_.end() and iter->second.get() == current)
+    {
+      current->Write(lane);
+      return;
+    }
+    this->Leave(current, lane);
+  }
+
+  auto &group = this->groups_[key];
+  if (not group)
+  {
+    group.reset(new Group(_network));
+  }
+
+  lane = static_cast< unsigned int >(group->lanes.size());
+  group->Reserve(lane + 1);
+  group->lanes.push_back({_network, false, nullptr, 0, 0});
+  group->Write(lane);
+
+  this->membership_[_network] = group.get();
+}
+
+/////////////////////////////////////////////////
+void BrainPool::Remove(NeuralNetwork *_network)
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+
+  Group *group;
+  unsigned int lane;
+  if (not this->Locate(_network, group, lane))
+  {
+    return;
+  }
+
+  group->Read(lane);
+  this->Leave(group, lane);
+}
+
+/////////////////////////////////////////////////
+void BrainPool::Fetch(NeuralNetwork *_network)
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+
+  Group *group;
+  unsigned int lane;
+  if (this->Locate(_network, group, lane))
+  {
+    group->Read(lane);
+  }
+}
+
+/////////////////////////////////////////////////
+bool BrainPool::Submit(
+    NeuralNetwork *_network,
+    const double *_inputs,
+    const std::vector< MotorPtr > &_motors,
+    const double _time,
+    const double _step)
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+
+  Group *group;
+  unsigned int lane;
+  if (not this->Locate(_network, group, lane))
+  {
+    return false;
+  }
+
+  for (unsigned int i = 0; i < group->nInputs; ++i)
+  {
+    group->state[i * group->stride + lane] = _inputs[i];
+  }
+
+  auto &entry = group->lanes[lane];
+  entry.pending = true;
+  entry.motors = &_motors;
+  entry.time = _time;
+  entry.step = _step;
+  group->times[lane] = _time;
+  group->pending = true;
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+void BrainPool::Flush()
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+
+  for (auto &iter : this->groups_)
+  {
+    auto &group = iter.second;
+    if (group->pending)
+    {
+      group->Step();
+      group->Actuate();
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+bool BrainPool::Locate(
+    const NeuralNetwork *_network,
+    Group *&_group,
+    unsigned int &_lane)
+{
+  auto iter = this->membership_.find(_network);
+  if (iter == this->membership_.end())
+  {
+    return false;
+  }
+
+  _group = iter->second;
+  for (unsigned int l = 0; l < _group->lanes.size(); ++l)
+  {
+    if (_group->lanes[l].network == _network)
+    {
+      _lane = l;
+      return true;
+    }
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+void BrainPool::Leave(Group *_group, const unsigned int _lane)
+{
+  this->membership_.erase(_group->lanes[_lane].network);
+  _group->Erase(_lane);
+
+  if (_group->lanes.empty())
+  {
+    for (auto iter = this->groups_.begin(); iter not_eq this->groups_.end();
+         ++iter)
+    {
+      if (iter->second.get() == _group)
+      {
+        this->groups_.erase(iter);
+        break;
+      }
+    }
+  }
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: World-scoped pool that evaluates the neural networks of all
+ *              robots sharing a neuron layout as one batch.
+ * Date: October 16, 2026
+ *
+ */
+
+#ifndef REVOLVE_GAZEBO_BRAIN_BRAINPOOL_H_
+#define REVOLVE_GAZEBO_BRAIN_BRAINPOOL_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+#include <gazebo/common/common.hh>
+#include <gazebo/gazebo.hh>
+
+#include <revolve/gazebo/Types.h>
+
+namespace revolve
+{
+  namespace gazebo
+  {
+    class NeuralNetwork;
+
+    class BrainPool;
+
+    typedef std::shared_ptr< BrainPool > BrainPoolPtr;
+
+    /// \brief Batched evaluator for the neural networks in one world.
+    /// \details Networks with the same inputs, outputs, hidden neurons,
+    /// neuron types, evaluation order and activation accuracy form a group.
+    /// A group stores the state, weights and params of all its robots as a
+    /// structure of arrays, with the robots (lanes) as the innermost
+    /// dimension, so one step of the whole group is a single sweep over
+    /// contiguous memory in which every inner loop runs across robots and
+    /// vectorizes.
+    ///
+    /// During the world update each pooled network only reads its sensors
+    /// and submits them. At the end of the world update the pool steps all
+    /// groups with pending robots and sends the outputs to their motors,
+    /// which therefore act one physics step later than when stepped from
+    /// `NeuralNetwork::Update()`.
+    class BrainPool
+    {
+      /// \brief Creates the pool of a world and registers it so that robot
+      /// brains in that world can find it
+      /// \param[in] _world The world
+      /// \return The pool, owned by the caller (the world plugin)
+      public: static BrainPoolPtr Create(
+          const ::gazebo::physics::WorldPtr &_world);
+
+      /// \return The pool of the given world, null if batching is disabled
+      public: static BrainPoolPtr Find(const std::string &_worldName);
+
+      /// \brief Constructor
+      public: explicit BrainPool(const std::string &_worldName);
+
+      /// \brief Destructor
+      public: ~BrainPool();
+
+      /// \brief Adds a network to the group matching its layout, or moves
+      /// a member there after it adopted a new layout
+      /// \details Networks with `CTRNN_SIGMOID` or `SUPG` neurons, with a
+      /// reduced weight precision or with a trace recorder are not added and
+      /// keep stepping by themselves. A member whose new layout has the key
+      /// of its current group only has its lane rewritten in place.
+      public: void Add(NeuralNetwork *_network);
+
+      /// \brief Removes a network, copying its state back into it
+      public: void Remove(NeuralNetwork *_network);
+
+      /// \brief Copies the pooled state of a network back into it, leaving
+      /// it in the pool
+      public: void Fetch(NeuralNetwork *_network);
+
+      /// \brief Queues a network for the next batched step
+      /// \param[in] _network The network
+      /// \param[in] _inputs Current sensor values
+      /// \param[in] _motors Motors receiving the outputs
+      /// \param[in] _time Current robot time
+      /// \param[in] _step Actuation time in seconds
+      /// \return False if the network is not in the pool, in which case the
+      /// caller has to step it by itself
+      public: bool Submit(
+          NeuralNetwork *_network,
+          const double *_inputs,
+          const std::vector< MotorPtr > &_motors,
+          const double _time,
+          const double _step);
+
+      /// \brief Steps all groups with pending networks and updates their
+      /// motors
+      public: void Flush();
+
+      /// \brief All networks sharing one layout
+      private: struct Group;
+
+      /// \brief Finds the group and lane of a network
+      /// \return False if the network is not in the pool
+      private: bool Locate(
+          const NeuralNetwork *_network,
+          Group *&_group,
+          unsigned int &_lane);
+
+      /// \brief Removes a lane from its group, and the group once empty,
+      /// without copying its state back
+      private: void Leave(Group *_group, const unsigned int _lane);
+
+      /// \brief Name of the world
+      private: std::string worldName_;
+
+      /// \brief Groups by layout key
+      private: std::map< std::vector< unsigned int >,
+                         std::unique_ptr< Group > > groups_;
+
+      /// \brief Group of every network
+      private: std::map< const NeuralNetwork *, Group * > membership_;
+
+      /// \brief Protects the groups while networks join or leave
+      private: boost::mutex mutex_;
+
+      /// \brief Connection to the world update end event
+      private: ::gazebo::event::ConnectionPtr updateConnection_;
+
+      /// \brief Pools by world name
+      /// \details This is a class member rather than a file local so that
+      /// the world and robot plugin libraries, which both link this code,
+      /// resolve to the same registry.
+      private: static std::map< std::string, std::weak_ptr< BrainPool > >
+          registry_;
+
+      /// \brief Protects `registry_`
+      private: static boost::mutex registryMutex_;
+    };
+  }
+}
+
+#endif  // REVOLVE_GAZEBO_BRAIN_BRAINPOOL_H_
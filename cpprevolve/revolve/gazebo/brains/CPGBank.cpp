@@ -0,0 +1,450 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: World-scoped bank that integrates the differential CPGs of
+ *              all robots as one set of arrays.
+ * Date: October 16, 2026
+ *
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "CPGBank.h"
+#include "DifferentialCPG.h"
+#include "../motors/Motor.h"
+
+namespace gz = gazebo;
+
+using namespace revolve::gazebo;
+
+std::map< std::string, std::weak_ptr< CPGBank > > CPGBank::registry_;
+
+boost::mutex CPGBank::registryMutex_;
+
+/////////////////////////////////////////////////
+struct CPGBank::Group
+{
+  /// \brief Per robot bookkeeping
+  struct Lane
+  {
+    /// \brief The CPG integrated in this lane
+    DifferentialCPG *cpg;
+
+    /// \brief Whether the CPG submitted since the last step
+    bool pending;
+
+    /// \brief Motors to update after the step
+    const std::vector< MotorPtr > *motors;
+
+    /// \brief Actuation time of the submission
+    double step;
+
+    /// \brief Sub-steps the CPG asks for
+    unsigned int steps;
+
+    /// \brief First neuron of the lane
+    size_t neuronOffset;
+
+    /// \brief First connection of the lane
+    size_t connectionOffset;
+
+    /// \brief First output of the lane
+    size_t outputOffset;
+  };
+
+  /// \brief Constructor
+  explicit Group(const CPGIntegrator _integrator);
+
+  /// \brief Copies connections, biases and state of all lanes into the group
+  void Pack();
+
+  /// \brief Copies the weights and state of one lane into the group
+  void Refresh(const unsigned int _lane);
+
+  /// \brief Copies the state of all lanes back into their CPGs
+  void Unpack();
+
+  /// \brief Integrates the CPGs of all pending lanes
+  void Step();
+
+  /// \brief Sends the outputs of all pending lanes to their motors
+  void Actuate();
+
+  /// \brief Integration scheme of all CPGs in the group
+  CPGIntegrator integrator;
+
+  /// \brief Robots in the group
+  std::vector< Lane > lanes;
+
+  /// \brief Whether any lane is pending
+  bool pending;
+
+  /// \brief Start of the incoming connections of every neuron of all lanes
+  std::vector< size_t > incoming;
+
+  /// \brief Source neuron of every connection, indexed across lanes
+  std::vector< size_t > sources;
+
+  /// \brief Weight of every connection
+  std::vector< double > weights;
+
+  /// \brief Bias of every neuron
+  std::vector< double > bias;
+
+  /// \brief Sub-step size of every neuron, zero in lanes that did not submit
+  std::vector< double > stepSizes;
+
+  /// \brief State of every neuron
+  std::vector< double > state;
+
+  /// \brief Runge-Kutta derivatives, four per neuron
+  std::vector< double > rates;
+
+  /// \brief Runge-Kutta intermediate state
+  std::vector< double > stage;
+
+  /// \brief Motor outputs of all lanes, one slice per lane
+  std::vector< double > outputs;
+};
+
+/////////////////////////////////////////////////
+CPGBank::Group::Group(const CPGIntegrator _integrator)
+    : integrator(_integrator)
+    , pending(false)
+{
+}
+
+/////////////////////////////////////////////////
+void CPGBank::Group::Pack()
+{
+  size_t numNeurons = 0;
+  size_t numConnections = 0;
+  size_t numOutputs = 0;
+  for (auto &lane : this->lanes)
+  {
+    lane.neuronOffset = numNeurons;
+    lane.connectionOffset = numConnections;
+    lane.outputOffset = numOutputs;
+    numNeurons += lane.cpg->state_.size();
+    numConnections += lane.cpg->sources_.size();
+    numOutputs += lane.cpg->state_.size() / 2;
+  }
+
+  this->incoming.resize(numNeurons + 1);
+  this->sources.resize(numConnections);
+  this->weights.resize(numConnections);
+  this->bias.resize(numNeurons);
+  this->stepSizes.assign(numNeurons, 0);
+  this->state.resize(numNeurons);
+  this->rates.resize(4 * numNeurons);
+  this->stage.resize(numNeurons);
+  this->outputs.resize(numOutputs);
+
+  for (const auto &lane : this->lanes)
+  {
+    const auto *cpg = lane.cpg;
+    for (size_t i = 0; i < cpg->state_.size(); ++i)
+    {
+      this->incoming[lane.neuronOffset + i] =
+          lane.connectionOffset + cpg->incoming_[i];
+      this->bias[lane.neuronOffset + i] = cpg->bias_[i];
+      this->state[lane.neuronOffset + i] = cpg->state_[i];
+    }
+    for (size_t k = 0; k < cpg->sources_.size(); ++k)
+    {
+      this->sources[lane.connectionOffset + k] =
+          lane.neuronOffset + cpg->sources_[k];
+      this->weights[lane.connectionOffset + k] = cpg->weights_[k];
+    }
+  }
+  this->incoming[numNeurons] = numConnections;
+}
+
+/////////////////////////////////////////////////
+void CPGBank::Group::Refresh(const unsigned int _lane)
+{
+  const auto &lane = this->lanes[_lane];
+  const auto *cpg = lane.cpg;
+  std::copy(cpg->weights_.begin(), cpg->weights_.end(),
+            this->weights.begin() + lane.connectionOffset);
+  std::copy(cpg->state_.begin(), cpg->state_.end(),
+            this->state.begin() + lane.neuronOffset);
+}
+
+/////////////////////////////////////////////////
+void CPGBank::Group::Unpack()
+{
+  for (const auto &lane : this->lanes)
+  {
+    auto &state = lane.cpg->state_;
+    std::copy(this->state.begin() + lane.neuronOffset,
+              this->state.begin() + lane.neuronOffset + state.size(),
+              state.begin());
+  }
+}
+
+/////////////////////////////////////////////////
+void CPGBank::Group::Step()
+{
+  // Lanes that did not submit this tick keep their state, since a sub-step
+  // of zero leaves every scheme in place
+  unsigned int steps = 0;
+  for (const auto &lane : this->lanes)
+  {
+    if (lane.pending and lane.step > 0)
+    {
+      steps = std::max(steps, lane.steps);
+    }
+  }
+  if (steps == 0)
+  {
+    return;
+  }
+
+  for (const auto &lane : this->lanes)
+  {
+    auto h = lane.pending ? lane.step / steps : 0.0;
+    std::fill(
+        this->stepSizes.begin() + lane.neuronOffset,
+        this->stepSizes.begin() + lane.neuronOffset +
+            lane.cpg->state_.size(),
+        h);
+  }
+
+  CPGArrays cpg;
+  cpg.neurons = this->state.size();
+  cpg.incoming = this->incoming.data();
+  cpg.sources = this->sources.data();
+  cpg.weights = this->weights.data();
+  cpg.bias = this->bias.data();
+  cpg.step = this->stepSizes.data();
+  cpg.state = this->state.data();
+  cpg.rates = this->rates.data();
+  cpg.stage = this->stage.data();
+  DifferentialCPG::Integrate(this->integrator, steps, cpg);
+}
+
+/////////////////////////////////////////////////
+void CPGBank::Group::Actuate()
+{
+  for (auto &lane : this->lanes)
+  {
+    if (not lane.pending)
+    {
+      continue;
+    }
+    lane.pending = false;
+
+    auto output = this->outputs.data() + lane.outputOffset;
+    lane.cpg->Output(this->state.data() + lane.neuronOffset, output);
+    if (lane.cpg->cycle_)
+    {
+      lane.cpg->cycle_->Record(lane.step, output);
+    }
+
+    unsigned int p = 0;
+    for (const auto &motor : *lane.motors)
+    {
+      motor->Update(output + p, lane.step);
+      p += motor->Outputs();
+    }
+  }
+  this->pending = false;
+}
+
+/////////////////////////////////////////////////
+CPGBankPtr CPGBank::Create(const ::gazebo::physics::WorldPtr &_world)
+{
+  auto name = _world->Name();
+  auto bank = std::make_shared< CPGBank >(name);
+
+  boost::mutex::scoped_lock lock(CPGBank::registryMutex_);
+  CPGBank::registry_[name] = bank;
+
+  std::cout << "Banking robot CPGs in world `" << name << "`." << std::endl;
+  return bank;
+}
+
+/////////////////////////////////////////////////
+CPGBankPtr CPGBank::Find(const std::string &_worldName)
+{
+  boost::mutex::scoped_lock lock(CPGBank::registryMutex_);
+  auto iter = CPGBank::registry_.find(_worldName);
+  if (iter == CPGBank::registry_.end())
+  {
+    return nullptr;
+  }
+  return iter->second.lock();
+}
+
+/////////////////////////////////////////////////
+CPGBank::CPGBank(const std::string &_worldName)
+    : worldName_(_worldName)
+{
+  this->updateConnection_ = gz::event::Events::ConnectWorldUpdateEnd(
+      boost::bind(&CPGBank::Flush, this));
+}
+
+/////////////////////////////////////////////////
+CPGBank::~CPGBank()
+{
+  this->updateConnection_.reset();
+
+  boost::mutex::scoped_lock lock(CPGBank::registryMutex_);
+  auto iter = CPGBank::registry_.find(this->worldName_);
+  if (iter not_eq CPGBank::registry_.end() and iter->second.expired())
+  {
+    CPGBank::registry_.erase(iter);
+  }
+}
+
+/////////////////////////////////////////////////
+void CPGBank::Add(DifferentialCPG *_cpg)
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+
+  auto key = static_cast< unsigned int >(_cpg->integrator_);
+  auto &group = this->groups_[key];
+  if (not group)
+  {
+    group.reset(new Group(_cpg->integrator_));
+  }
+
+  // Save the state of the current lanes before the arrays are rebuilt
+  group->Unpack();
+  group->lanes.push_back({_cpg, false, nullptr, 0, 0, 0, 0, 0});
+  group->Pack();
+
+  this->membership_[_cpg] = group.get();
+}
+
+/////////////////////////////////////////////////
+void CPGBank::Remove(DifferentialCPG *_cpg)
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+
+  Group *group;
+  unsigned int lane;
+  if (not this->Locate(_cpg, group, lane))
+  {
+    return;
+  }
+
+  group->Unpack();
+  group->lanes.erase(group->lanes.begin() + lane);
+  this->membership_.erase(_cpg);
+
+  if (group->lanes.empty())
+  {
+    for (auto iter = this->groups_.begin(); iter not_eq this->groups_.end();
+         ++iter)
+    {
+      if (iter->second.get() == group)
+      {
+        this->groups_.erase(iter);
+        break;
+      }
+    }
+    return;
+  }
+
+  group->Pack();
+  group->pending = std::any_of(
+      group->lanes.begin(),
+      group->lanes.end(),
+      [](const Group::Lane &_lane) { return _lane.pending; });
+}
+
+/////////////////////////////////////////////////
+void CPGBank::Refresh(DifferentialCPG *_cpg)
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+
+  Group *group;
+  unsigned int lane;
+  if (this->Locate(_cpg, group, lane))
+  {
+    group->Refresh(lane);
+  }
+}
+
+/////////////////////////////////////////////////
+bool CPGBank::Submit(
+    DifferentialCPG *_cpg,
+    const std::vector< MotorPtr > &_motors,
+    const double _step)
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+
+  Group *group;
+  unsigned int lane;
+  if (not this->Locate(_cpg, group, lane))
+  {
+    return false;
+  }
+
+  auto &entry = group->lanes[lane];
+  entry.pending = true;
+  entry.motors = &_motors;
+  entry.step = _step;
+  entry.steps = _cpg->SubSteps(_step);
+  group->pending = true;
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+void CPGBank::Flush()
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+
+  for (auto &iter : this->groups_)
+  {
+    auto &group = iter.second;
+    if (group->pending)
+    {
+      group->Step();
+      group->Actuate();
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+bool CPGBank::Locate(
+    const DifferentialCPG *_cpg,
+    Group *&_group,
+    unsigned int &_lane)
+{
+  auto iter = this->membership_.find(_cpg);
+  if (iter == this->membership_.end())
+  {
+    return false;
+  }
+
+  _group = iter->second;
+  for (unsigned int l = 0; l < _group->lanes.size(); ++l)
+  {
+    if (_group->lanes[l].cpg == _cpg)
+    {
+      _lane = l;
+      return true;
+    }
+  }
+  return false;
+}
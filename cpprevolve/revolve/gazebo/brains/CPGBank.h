@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: World-scoped bank that integrates the differential CPGs of
+ *              all robots as one set of arrays.
+ * Date: October 16, 2026
+ *
+ */
+
+#ifndef REVOLVE_GAZEBO_BRAIN_CPGBANK_H_
+#define REVOLVE_GAZEBO_BRAIN_CPGBANK_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+#include <gazebo/common/common.hh>
+#include <gazebo/gazebo.hh>
+
+#include <revolve/gazebo/Types.h>
+
+namespace revolve
+{
+  namespace gazebo
+  {
+    class DifferentialCPG;
+
+    class CPGBank;
+
+    typedef std::shared_ptr< CPGBank > CPGBankPtr;
+
+    /// \brief Batched integrator for the differential CPGs in one world.
+    /// \details CPGs with the same integration scheme form a group. A group
+    /// concatenates the neurons and connections of all its robots into one
+    /// set of contiguous arrays, with the connections indexed across robots,
+    /// so one step of the whole group is a single sweep of the integration
+    /// kernel. Every neuron has its own sub-step size, which is zero for
+    /// robots that did not submit, and a group takes the largest number of
+    /// sub-steps any of its robots asks for.
+    ///
+    /// During the world update each banked CPG only submits its motors. At
+    /// the end of the world update the bank steps all groups with pending
+    /// robots and sends the outputs to their motors, which therefore act one
+    /// physics step later than when stepped from `DifferentialCPG::Update()`.
+    class CPGBank
+    {
+      /// \brief Creates the bank of a world and registers it so that robot
+      /// brains in that world can find it
+      /// \param[in] _world The world
+      /// \return The bank, owned by the caller (the world plugin)
+      public: static CPGBankPtr Create(
+          const ::gazebo::physics::WorldPtr &_world);
+
+      /// \return The bank of the given world, null if banking is disabled
+      public: static CPGBankPtr Find(const std::string &_worldName);
+
+      /// \brief Constructor
+      public: explicit CPGBank(const std::string &_worldName);
+
+      /// \brief Destructor
+      public: ~CPGBank();
+
+      /// \brief Adds a CPG to the group of its integration scheme
+      public: void Add(DifferentialCPG *_cpg);
+
+      /// \brief Removes a CPG, copying its state back into it
+      public: void Remove(DifferentialCPG *_cpg);
+
+      /// \brief Copies new weights and states of a CPG into the bank
+      public: void Refresh(DifferentialCPG *_cpg);
+
+      /// \brief Queues a CPG for the next batched step
+      /// \param[in] _cpg The CPG
+      /// \param[in] _motors Motors receiving the outputs
+      /// \param[in] _step Actuation time in seconds
+      /// \return False if the CPG is not in the bank, in which case the
+      /// caller has to step it by itself
+      public: bool Submit(
+          DifferentialCPG *_cpg,
+          const std::vector< MotorPtr > &_motors,
+          const double _step);
+
+      /// \brief Steps all groups with pending CPGs and updates their motors
+      public: void Flush();
+
+      /// \brief All CPGs sharing an integration scheme
+      private: struct Group;
+
+      /// \brief Finds the group and lane of a CPG
+      /// \return False if the CPG is not in the bank
+      private: bool Locate(
+          const DifferentialCPG *_cpg,
+          Group *&_group,
+          unsigned int &_lane);
+
+      /// \brief Name of the world
+      private: std::string worldName_;
+
+      /// \brief Groups by integration scheme
+      private: std::map< unsigned int, std::unique_ptr< Group > > groups_;
+
+      /// \brief Group of every CPG
+      private: std::map< const DifferentialCPG *, Group * > membership_;
+
+      /// \brief Protects the groups while CPGs join or leave
+      private: boost::mutex mutex_;
+
+      /// \brief Connection to the world update end event
+      private: ::gazebo::event::ConnectionPtr updateConnection_;
+
+      /// \brief Banks by world name
+      /// \details A class member like `BrainPool::registry_`, so that the
+      /// world and robot plugin libraries resolve to the same registry.
+      private: static std::map< std::string, std::weak_ptr< CPGBank > >
+          registry_;
+
+      /// \brief Protects `registry_`
+      private: static boost::mutex registryMutex_;
+    };
+  }
+}
+
+#endif  // REVOLVE_GAZEBO_BRAIN_CPGBANK_H_
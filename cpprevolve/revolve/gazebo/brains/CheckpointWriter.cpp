@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Background writer of the RLPower checkpoints.
+ * Date: October 16, 2026
+ *
+ */
+
+#include <iostream>
+#include <utility>
+
+#include "CheckpointWriter.h"
+
+using namespace revolve::gazebo;
+
+/////////////////////////////////////////////////
+CheckpointWriter::CheckpointWriter(const std::string &_path)
+    : path_(_path)
+    , hasPending_(false)
+    , failed_(false)
+    , running_(true)
+{
+  this->thread_ = std::thread(&CheckpointWriter::Run, this);
+}
+
+/////////////////////////////////////////////////
+CheckpointWriter::~CheckpointWriter()
+{
+  {
+    boost::mutex::scoped_lock lock(this->mutex_);
+    this->running_ = false;
+  }
+  this->condition_.notify_one();
+  this->thread_.join();
+}
+
+/////////////////////////////////////////////////
+void CheckpointWriter::Submit(PolicyCheckpoint::State &_state)
+{
+  {
+    boost::mutex::scoped_lock lock(this->mutex_);
+    std::swap(this->pending_, _state);
+    this->hasPending_ = true;
+  }
+  this->condition_.notify_one();
+}
+
+/////////////////////////////////////////////////
+void CheckpointWriter::Run()
+{
+  PolicyCheckpoint::State state;
+  boost::mutex::scoped_lock lock(this->mutex_);
+  while (true)
+  {
+    while (this->running_ and not this->hasPending_)
+    {
+      this->condition_.wait(lock);
+    }
+    // The last snapshot is written before the thread stops
+    if (not this->hasPending_)
+    {
+      break;
+    }
+    std::swap(state, this->pending_);
+    this->hasPending_ = false;
+
+    lock.unlock();
+    auto saved = PolicyCheckpoint::Save(this->path_, state);
+    if (not saved)
+    {
+      std::cerr << "Checkpoint after " << state.evaluations
+                << " evaluations not saved, retrying after the next one."
+                << std::endl;
+    }
+    this->failed_ = not saved;
+    lock.lock();
+  }
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Background writer of the RLPower checkpoints.
+ * Date: October 16, 2026
+ *
+ */
+
+#ifndef REVOLVE_GAZEBO_BRAIN_CHECKPOINTWRITER_H_
+#define REVOLVE_GAZEBO_BRAIN_CHECKPOINTWRITER_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "PolicyCheckpoint.h"
+
+namespace revolve
+{
+  namespace gazebo
+  {
+    class CheckpointWriter;
+
+    typedef std::unique_ptr< CheckpointWriter > CheckpointWriterPtr;
+
+    /// \brief Writes the checkpoints of a brain on a background thread.
+    /// \details Saving flushes the file and its directory to disk, which
+    /// must neither stall the update thread nor hold the archive that the
+    /// robots of a population share. `Submit()` only hands over a snapshot.
+    /// A snapshot that arrives before the previous one was written replaces
+    /// it, so a slow disk skips checkpoints instead of queueing them.
+    class CheckpointWriter
+    {
+      /// \brief Constructor, starts the writer thread
+      /// \param[in] _path Checkpoint file
+      public: explicit CheckpointWriter(const std::string &_path);
+
+      /// \brief Destructor, writes the pending snapshot and stops the thread
+      public: ~CheckpointWriter();
+
+      /// \brief Queues a snapshot for writing
+      /// \param[in,out] _state Snapshot, swapped with a spare one so that
+      /// its buffers are reused by the next `PolicyCheckpoint::Snapshot()`
+      public: void Submit(PolicyCheckpoint::State &_state);
+
+      /// \return Whether the last written snapshot failed to save, so the
+      /// caller should submit another one as soon as possible
+      public: bool Failed() const { return this->failed_; }
+
+      /// \brief Body of the writer thread
+      private: void Run();
+
+      /// \brief Checkpoint file
+      private: std::string path_;
+
+      /// \brief Snapshot waiting to be written
+      private: PolicyCheckpoint::State pending_;
+
+      /// \brief Whether `pending_` holds a snapshot
+      private: bool hasPending_;
+
+      /// \brief Set when a save failed, cleared when one succeeds
+      private: std::atomic< bool > failed_;
+
+      /// \brief Cleared to stop the writer thread
+      private: bool running_;
+
+      /// \brief Protects `pending_`, `hasPending_` and `running_`
+      private: boost::mutex mutex_;
+
+      /// \brief Wakes the writer thread
+      private: boost::condition_variable condition_;
+
+      /// \brief Writer thread
+      private: std::thread thread_;
+    };
+  }
+}
+
+#endif  // REVOLVE_GAZEBO_BRAIN_CHECKPOINTWRITER_H_
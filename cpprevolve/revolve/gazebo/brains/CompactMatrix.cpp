@@ -0,0 +1,319 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Dense weight matrix stored in single precision or as int8
+ *              with a scale per row.
+ * Date: October 16, 2026
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+// The vector kernels are compiled with per-function target attributes, so
+// the rest of the plugin does not need to be built for a specific CPU.
+#if defined(__GNUC__) and (defined(__x86_64__) or defined(__i386__))
+#define REVOLVE_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+#include "CompactMatrix.h"
+
+using namespace revolve::gazebo;
+
+/////////////////////////////////////////////////
+static void MultiplyFloatScalar(
+    const void *_matrix,
+    const float */*_scales*/,
+    const unsigned int _stride,
+    const unsigned int *_rows,
+    const unsigned int _count,
+    const float *_x,
+    double *_y)
+{
+  auto matrix = static_cast< const float * >(_matrix);
+  for (unsigned int k = 0; k < _count; ++k)
+  {
+    auto i = _rows ? _rows[k] : k;
+    auto row = matrix + i * _stride;
+    float sum = 0;
+    for (unsigned int j = 0; j < _stride; ++j)
+    {
+      sum += row[j] * _x[j];
+    }
+    _y[i] = sum;
+  }
+}
+
+/////////////////////////////////////////////////
+static void MultiplyInt8Scalar(
+    const void *_matrix,
+    const float *_scales,
+    const unsigned int _stride,
+    const unsigned int *_rows,
+    const unsigned int _count,
+    const float *_x,
+    double *_y)
+{
+  auto matrix = static_cast< const int8_t * >(_matrix);
+  for (unsigned int k = 0; k < _count; ++k)
+  {
+    auto i = _rows ? _rows[k] : k;
+    auto row = matrix + i * _stride;
+    float sum = 0;
+    for (unsigned int j = 0; j < _stride; ++j)
+    {
+      sum += row[j] * _x[j];
+    }
+    _y[i] = sum * _scales[i];
+  }
+}
+
+#ifdef REVOLVE_X86_KERNELS
+/////////////////////////////////////////////////
+__attribute__((target("avx2,fma")))
+static float HorizontalSum(const __m256 _sum)
+{
+  auto low = _mm_add_ps(
+      _mm256_castps256_ps128(_sum), _mm256_extractf128_ps(_sum, 1));
+  low = _mm_add_ps(low, _mm_movehl_ps(low, low));
+  low = _mm_add_ss(low, _mm_movehdup_ps(low));
+  return _mm_cvtss_f32(low);
+}
+
+/////////////////////////////////////////////////
+__attribute__((target("avx2,fma")))
+static void MultiplyFloatAvx2(
+    const void *_matrix,
+    const float */*_scales*/,
+    const unsigned int _stride,
+    const unsigned int *_rows,
+    const unsigned int _count,
+    const float *_x,
+    double *_y)
+{
+  auto matrix = static_cast< const float * >(_matrix);
+  for (unsigned int k = 0; k < _count; ++k)
+  {
+    auto i = _rows ? _rows[k] : k;
+    auto row = matrix + i * _stride;
+    auto sum = _mm256_setzero_ps();
+    for (unsigned int j = 0; j < _stride; j += 8)
+    {
+      sum = _mm256_fmadd_ps(
+          _mm256_loadu_ps(row + j), _mm256_loadu_ps(_x + j), sum);
+    }
+    _y[i] = HorizontalSum(sum);
+  }
+}
+
+/////////////////////////////////////////////////
+__attribute__((target("avx2,fma")))
+static void MultiplyInt8Avx2(
+    const void *_matrix,
+    const float *_scales,
+    const unsigned int _stride,
+    const unsigned int *_rows,
+    const unsigned int _count,
+    const float *_x,
+    double *_y)
+{
+  auto matrix = static_cast< const int8_t * >(_matrix);
+  for (unsigned int k = 0; k < _count; ++k)
+  {
+    auto i = _rows ? _rows[k] : k;
+    auto row = matrix + i * _stride;
+    auto sum = _mm256_setzero_ps();
+    for (unsigned int j = 0; j < _stride; j += 8)
+    {
+      // Widen eight bytes to eight floats
+      auto bytes = _mm_loadl_epi64(reinterpret_cast< const __m128i * >(
+          row + j));
+      auto weights = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(bytes));
+      sum = _mm256_fmadd_ps(weights, _mm256_loadu_ps(_x + j), sum);
+    }
+    _y[i] = HorizontalSum(sum) * _scales[i];
+  }
+}
+#endif
+
+/////////////////////////////////////////////////
+static bool HasAvx2()
+{
+#ifdef REVOLVE_X86_KERNELS
+  static const bool avx2 = []()
+  {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma");
+  }();
+  return avx2;
+#else
+  return false;
+#endif
+}
+
+/////////////////////////////////////////////////
+CompactMatrix::CompactMatrix()
+    : rows_(0)
+    , cols_(0)
+    , stride_(0)
+    , kernel_(MultiplyFloatScalar)
+{
+}
+
+/////////////////////////////////////////////////
+CompactMatrix::CompactMatrix(
+    const SparseMatrix &_sparse,
+    const WeightPrecision _precision)
+    : rows_(_sparse.Rows())
+    , cols_(_sparse.Cols())
+{
+  // Round the row length up to a whole number of vectors
+  this->stride_ = ((this->cols_ + VECTOR_WIDTH - 1) / VECTOR_WIDTH) *
+                  VECTOR_WIDTH;
+
+  const auto &offsets = _sparse.Offsets();
+  const auto &columns = _sparse.Columns();
+  const auto &values = _sparse.Values();
+  switch (_precision)
+  {
+    case FLOAT_WEIGHTS:
+      this->floats_.assign(this->rows_ * this->stride_, 0);
+      for (unsigned int i = 0; i < this->rows_; ++i)
+      {
+        for (auto k = offsets[i]; k < offsets[i + 1]; ++k)
+        {
+          this->floats_[i * this->stride_ + columns[k]] =
+              static_cast< float >(values[k]);
+        }
+      }
+      this->kernel_ = HasAvx2() ? MultiplyFloatAvx2 : MultiplyFloatScalar;
+      break;
+    case INT8_WEIGHTS:
+      this->bytes_.assign(this->rows_ * this->stride_, 0);
+      this->scales_.assign(this->rows_, 0);
+      for (unsigned int i = 0; i < this->rows_; ++i)
+      {
+        double largest = 0;
+        for (auto k = offsets[i]; k < offsets[i + 1]; ++k)
+        {
+          largest = std::max(largest, std::fabs(values[k]));
+        }
+        if (not (largest > 0))
+        {
+          continue;
+        }
+
+        auto scale = largest / 127.0;
+        this->scales_[i] = static_cast< float >(scale);
+        for (auto k = offsets[i]; k < offsets[i + 1]; ++k)
+        {
+          this->bytes_[i * this->stride_ + columns[k]] =
+              static_cast< int8_t >(std::lround(values[k] / scale));
+        }
+      }
+      this->kernel_ = HasAvx2() ? MultiplyInt8Avx2 : MultiplyInt8Scalar;
+      break;
+    case DOUBLE_WEIGHTS:
+    default:
+      std::cerr << "A compact matrix holds floats or bytes, must be a bug."
+                << std::endl;
+      throw std::runtime_error("Robot brain error");
+  }
+}
+
+/////////////////////////////////////////////////
+void CompactMatrix::Multiply(
+    const double *_x,
+    float *_input,
+    double *_y) const
+{
+  this->Run(nullptr, this->rows_, _x, _input, _y);
+}
+
+/////////////////////////////////////////////////
+void CompactMatrix::MultiplyRows(
+    const unsigned int *_rows,
+    const unsigned int _count,
+    const double *_x,
+    float *_input,
+    double *_y) const
+{
+  this->Run(_rows, _count, _x, _input, _y);
+}
+
+/////////////////////////////////////////////////
+void CompactMatrix::Run(
+    const unsigned int *_rows,
+    const unsigned int _count,
+    const double *_x,
+    float *_input,
+    double *_y) const
+{
+  // The padding stays zero, so a NaN or infinity beyond the last column
+  // cannot leak into the result.
+  std::copy(_x, _x + this->cols_, _input);
+  if (this->bytes_.empty())
+  {
+    this->kernel_(
+        this->floats_.data(),
+        nullptr,
+        this->stride_,
+        _rows,
+        _count,
+        _input,
+        _y);
+  }
+  else
+  {
+    this->kernel_(
+        this->bytes_.data(),
+        this->scales_.data(),
+        this->stride_,
+        _rows,
+        _count,
+        _input,
+        _y);
+  }
+}
+
+/////////////////////////////////////////////////
+WeightPrecision CompactMatrix::ParsePrecision(const std::string &_name)
+{
+  if ("double" == _name)
+  {
+    return DOUBLE_WEIGHTS;
+  }
+  if ("float" == _name)
+  {
+    return FLOAT_WEIGHTS;
+  }
+  if ("int8" == _name)
+  {
+    return INT8_WEIGHTS;
+  }
+
+  std::cerr << "Unknown weight precision `" << _name
+            << "`, expected `double`, `float` or `int8`." << std::endl;
+  throw std::runtime_error("Robot brain error");
+}
+
+/////////////////////////////////////////////////
+std::string CompactMatrix::KernelName()
+{
+  return HasAvx2() ? "AVX2" : "scalar";
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Dense weight matrix stored in single precision or as int8
+ *              with a scale per row.
+ * Date: October 16, 2026
+ *
+ */
+
+#ifndef REVOLVE_GAZEBO_BRAIN_COMPACTMATRIX_H_
+#define REVOLVE_GAZEBO_BRAIN_COMPACTMATRIX_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SparseMatrix.h"
+
+namespace revolve
+{
+  namespace gazebo
+  {
+    /// \brief Storage precision of the weights of a brain
+    enum WeightPrecision
+    {
+      /// \brief Doubles, the matrices chosen by the network layout
+      DOUBLE_WEIGHTS,
+
+      /// \brief Floats
+      FLOAT_WEIGHTS,
+
+      /// \brief Signed bytes with a float scale per row
+      INT8_WEIGHTS
+    };
+
+    /// \brief Row-major weight matrix with reduced precision.
+    /// \details Rows are padded with zeros up to a multiple of
+    /// `VECTOR_WIDTH` elements. The input vector is converted to floats once
+    /// per multiplication and the sums are accumulated in floats, eight
+    /// lanes at a time on CPUs with AVX2 and FMA, so a row costs half the
+    /// memory traffic of a double row with floats and a quarter with int8.
+    ///
+    /// An int8 row stores `round(w / s)` with `s = max |w| / 127`, which
+    /// bounds the error of every weight by `s / 2`.
+    class CompactMatrix
+    {
+      /// \brief Number of floats in an AVX2 vector
+      public: static const unsigned int VECTOR_WIDTH = 8;
+
+      /// \brief Kernel computing the rows listed in `_rows`, or the first
+      /// `_count` rows if `_rows` is null
+      /// \param[in] _matrix Padded floats or bytes
+      /// \param[in] _scales Scale of every row, null for floats
+      /// \param[in] _stride Padded row length
+      public: typedef void (*Kernel)(
+          const void *_matrix,
+          const float *_scales,
+          const unsigned int _stride,
+          const unsigned int *_rows,
+          const unsigned int _count,
+          const float *_x,
+          double *_y);
+
+      /// \brief Constructor
+      public: CompactMatrix();
+
+      /// \brief Builds a reduced copy of a sparse matrix
+      /// \param[in] _sparse Weights
+      /// \param[in] _precision `FLOAT_WEIGHTS` or `INT8_WEIGHTS`
+      public: CompactMatrix(
+          const SparseMatrix &_sparse,
+          const WeightPrecision _precision);
+
+      /// \brief Computes `_y = A * _x`
+      /// \param[in] _x Input vector of `Cols()` elements
+      /// \param[in,out] _input Zero padded float copy of the input,
+      /// `Stride()` elements owned by the caller so that the matrix is never
+      /// written and can be shared between threads
+      /// \param[out] _y Output vector of `Rows()` elements
+      public: void Multiply(
+          const double *_x,
+          float *_input,
+          double *_y) const;
+
+      /// \brief Computes `_y[r] = A[r] * _x` for the rows `r` in `_rows`
+      /// \param[in] _rows Rows to compute
+      /// \param[in] _count Number of rows in `_rows`
+      /// \param[in] _x Input vector of `Cols()` elements
+      /// \param[in,out] _input Scratch as for `Multiply()`
+      /// \param[out] _y Output vector, indexed by row
+      public: void MultiplyRows(
+          const unsigned int *_rows,
+          const unsigned int _count,
+          const double *_x,
+          float *_input,
+          double *_y) const;
+
+      /// \return Number of rows
+      public: unsigned int Rows() const { return this->rows_; }
+
+      /// \return Number of columns
+      public: unsigned int Cols() const { return this->cols_; }
+
+      /// \return Padded row length
+      public: unsigned int Stride() const { return this->stride_; }
+
+      /// \brief Parses a precision name as used in the robot SDF
+      /// \param[in] _name `double`, `float` or `int8`
+      public: static WeightPrecision ParsePrecision(const std::string &_name);
+
+      /// \return Name of the instruction set used by the kernels
+      public: static std::string KernelName();
+
+      /// \brief Converts the input and runs the kernel
+      private: void Run(
+          const unsigned int *_rows,
+          const unsigned int _count,
+          const double *_x,
+          float *_input,
+          double *_y) const;
+
+      /// \brief Number of rows
+      private: unsigned int rows_;
+
+      /// \brief Number of columns
+      private: unsigned int cols_;
+
+      /// \brief Padded row length
+      private: unsigned int stride_;
+
+      /// \brief Padded weights of a float matrix
+      private: std::vector< float > floats_;
+
+      /// \brief Padded weights of an int8 matrix
+      private: std::vector< int8_t > bytes_;
+
+      /// \brief Scale of every row of an int8 matrix
+      private: std::vector< float > scales_;
+
+      /// \brief Kernel used by `Multiply()` and `MultiplyRows()`
+      private: Kernel kernel_;
+    };
+  }
+}
+
+#endif  // REVOLVE_GAZEBO_BRAIN_COMPACTMATRIX_H_
@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Dense, row-major weight matrix with SIMD matrix-vector
+ *              kernels selected at runtime from the CPU features.
+ * Date: October 16, 2026
+ *
+ */
+
+#include <algorithm>
+
+// The vector kernels are compiled with per-function target attributes, so
+// the rest of the plugin does not need to be built for a specific CPU.
+#if defined(__GNUC__) and (defined(__x86_64__) or defined(__i386__))
+#define REVOLVE_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+#include "DenseMatrix.h"
+
+using namespace revolve::gazebo;
+
+/////////////////////////////////////////////////
+static void MultiplyScalar(
+    const double *_matrix,
+    const unsigned int _rows,
+    const unsigned int _stride,
+    const double *_x,
+    double *_y)
+{
+  for (unsigned int i = 0; i < _rows; ++i)
+  {
+    const double *row = _matrix + i * _stride;
+    double sum = 0;
+    for (unsigned int j = 0; j < _stride; ++j)
+    {
+      sum += row[j] * _x[j];
+    }
+    _y[i] = sum;
+  }
+}
+
+#ifdef REVOLVE_X86_KERNELS
+/////////////////////////////////////////////////
+__attribute__((target("avx2,fma")))
+static void MultiplyAvx2(
+    const double *_matrix,
+    const unsigned int _rows,
+    const unsigned int _stride,
+    const double *_x,
+    double *_y)
+{
+  for (unsigned int i = 0; i < _rows; ++i)
+  {
+    const double *row = _matrix + i * _stride;
+
+    // Two independent accumulators hide the FMA latency
+    auto sum0 = _mm256_setzero_pd();
+    auto sum1 = _mm256_setzero_pd();
+    for (unsigned int j = 0; j < _stride; j += 8)
+    {
+      sum0 = _mm256_fmadd_pd(
+          _mm256_loadu_pd(row + j), _mm256_loadu_pd(_x + j), sum0);
+      sum1 = _mm256_fmadd_pd(
+          _mm256_loadu_pd(row + j + 4), _mm256_loadu_pd(_x + j + 4), sum1);
+    }
+    auto sum = _mm256_add_pd(sum0, sum1);
+
+    // Horizontal sum of the four lanes
+    auto low = _mm256_castpd256_pd128(sum);
+    auto high = _mm256_extractf128_pd(sum, 1);
+    low = _mm_add_pd(low, high);
+    low = _mm_add_sd(low, _mm_unpackhi_pd(low, low));
+    _y[i] = _mm_cvtsd_f64(low);
+  }
+}
+
+/////////////////////////////////////////////////
+__attribute__((target("avx512f")))
+static void MultiplyAvx512(
+    const double *_matrix,
+    const unsigned int _rows,
+    const unsigned int _stride,
+    const double *_x,
+    double *_y)
+{
+  for (unsigned int i = 0; i < _rows; ++i)
+  {
+    const double *row = _matrix + i * _stride;
+    auto sum = _mm512_setzero_pd();
+    for (unsigned int j = 0; j < _stride; j += 8)
+    {
+      sum = _mm512_fmadd_pd(
+          _mm512_loadu_pd(row + j), _mm512_loadu_pd(_x + j), sum);
+    }
+
+    // Horizontal sum of the eight lanes
+    double lanes[8];
+    _mm512_storeu_pd(lanes, sum);
+    _y[i] = ((lanes[0] + lanes[4]) + (lanes[1] + lanes[5])) +
+            ((lanes[2] + lanes[6]) + (lanes[3] + lanes[7]));
+  }
+}
+#endif
+
+/////////////////////////////////////////////////
+DenseMatrix::DenseMatrix()
+    : rows_(0)
+    , cols_(0)
+    , stride_(0)
+    , kernel_(DenseMatrix::BestKernel())
+{
+}
+
+/////////////////////////////////////////////////
+DenseMatrix::DenseMatrix(const SparseMatrix &_sparse)
+    : rows_(_sparse.Rows())
+    , cols_(_sparse.Cols())
+    , kernel_(DenseMatrix::BestKernel())
+{
+  // Round the row length up to a whole number of vectors
+  this->stride_ = ((this->cols_ + VECTOR_WIDTH - 1) / VECTOR_WIDTH) *
+                  VECTOR_WIDTH;
+  this->values_.assign(this->rows_ * this->stride_, 0);
+
+  const auto &offsets = _sparse.Offsets();
+  const auto &columns = _sparse.Columns();
+  const auto &values = _sparse.Values();
+  for (unsigned int i = 0; i < this->rows_; ++i)
+  {
+    for (auto k = offsets[i]; k < offsets[i + 1]; ++k)
+    {
+      this->values_[i * this->stride_ + columns[k]] = values[k];
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void DenseMatrix::Multiply(
+    const double *_x,
+    double *_input,
+    double *_y) const
+{
+  // The padding of the input has to be zero as well, otherwise a NaN or
+  // infinity beyond the last column would leak into the result.
+  std::copy(_x, _x + this->cols_, _input);
+  this->kernel_(
+      this->values_.data(),
+      this->rows_,
+      this->stride_,
+      _input,
+      _y);
+}
+
+/////////////////////////////////////////////////
+DenseMatrix::Kernel DenseMatrix::BestKernel()
+{
+#ifdef REVOLVE_X86_KERNELS
+  static const Kernel kernel = []() -> Kernel
+  {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+      return MultiplyAvx512;
+    }
+    if (__builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma"))
+    {
+      return MultiplyAvx2;
+    }
+    return MultiplyScalar;
+  }();
+  return kernel;
+#else
+  return MultiplyScalar;
+#endif
+}
+
+/////////////////////////////////////////////////
+std::string DenseMatrix::KernelName()
+{
+  auto kernel = DenseMatrix::BestKernel();
+#ifdef REVOLVE_X86_KERNELS
+  if (kernel == MultiplyAvx512)
+  {
+    return "AVX-512";
+  }
+  if (kernel == MultiplyAvx2)
+  {
+    return "AVX2";
+  }
+#endif
+  return kernel == MultiplyScalar ? "scalar" : "unknown";
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Dense, row-major weight matrix with SIMD matrix-vector
+ *              kernels selected at runtime from the CPU features.
+ * Date: October 16, 2026
+ *
+ */
+
+#ifndef REVOLVE_GAZEBO_BRAIN_DENSEMATRIX_H_
+#define REVOLVE_GAZEBO_BRAIN_DENSEMATRIX_H_
+
+#include <string>
+#include <vector>
+
+#include "SparseMatrix.h"
+
+namespace revolve
+{
+  namespace gazebo
+  {
+    /// \brief Dense weight matrix stored row-major per target neuron.
+    /// \details Every row is padded with zeros up to a multiple of
+    /// `VECTOR_WIDTH` doubles, so the kernels only ever work on full vectors
+    /// and the weights of one target neuron are contiguous in memory.
+    class DenseMatrix
+    {
+      /// \brief Number of doubles in the widest supported vector (AVX-512)
+      public: static const unsigned int VECTOR_WIDTH = 8;
+
+      /// \brief Matrix-vector kernel signature
+      /// \param[in] _matrix Padded row-major matrix
+      /// \param[in] _rows Number of rows
+      /// \param[in] _stride Padded row length, a multiple of `VECTOR_WIDTH`
+      /// \param[in] _x Input vector of `_stride` elements
+      /// \param[out] _y Output vector of `_rows` elements
+      public: typedef void (*Kernel)(
+          const double *_matrix,
+          const unsigned int _rows,
+          const unsigned int _stride,
+          const double *_x,
+          double *_y);
+
+      /// \brief Constructor
+      public: DenseMatrix();
+
+      /// \brief Builds a dense copy of a sparse matrix
+      public: explicit DenseMatrix(const SparseMatrix &_sparse);
+
+      /// \brief Computes `_y = A * _x`
+      /// \param[in] _x Input vector of `Cols()` elements
+      /// \param[in,out] _input Zero padded copy of the input, `Stride()`
+      /// elements owned by the caller so that the matrix is never written
+      /// and can be shared between threads
+      /// \param[out] _y Output vector of `Rows()` elements
+      public: void Multiply(
+          const double *_x,
+          double *_input,
+          double *_y) const;
+
+      /// \return Number of rows
+      public: unsigned int Rows() const { return this->rows_; }
+
+      /// \return Number of columns
+      public: unsigned int Cols() const { return this->cols_; }
+
+      /// \return Padded row length
+      public: unsigned int Stride() const { return this->stride_; }
+
+      /// \return The kernel for the best instruction set of this CPU
+      public: static Kernel BestKernel();
+
+      /// \return Name of the instruction set used by `BestKernel()`
+      public: static std::string KernelName();
+
+      /// \brief Number of rows
+      private: unsigned int rows_;
+
+      /// \brief Number of columns
+      private: unsigned int cols_;
+
+      /// \brief Padded row length
+      private: unsigned int stride_;
+
+      /// \brief Padded weights, `rows_ * stride_` elements
+      private: std::vector< double > values_;
+
+      /// \brief Kernel used by `Multiply()`
+      private: Kernel kernel_;
+    };
+  }
+}
+
+#endif  // REVOLVE_GAZEBO_BRAIN_DENSEMATRIX_H_
@@ -19,9 +19,14 @@
  *
  */
 
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
+#include <limits>
 #include <map>
+#include <string>
 #include <tuple>
+#include <utility>
 
 #include "../motors/Motor.h"
 #include "../sensors/Sensor.h"
@@ -32,15 +37,28 @@ namespace gz = gazebo;
 
 using namespace revolve::gazebo;
 
+/// Acquisition rounds per proposal, each around the best candidate of the
+/// previous one
+static const size_t ACQUISITION_ROUNDS = 3;
+
+/// Spread of the first acquisition round around the best weights
+static const double ACQUISITION_SPREAD = 0.1;
+
 /////////////////////////////////////////////////
 DifferentialCPG::DifferentialCPG(
     const ::gazebo::physics::ModelPtr &_model,
     const sdf::ElementPtr _settings,
     const std::vector< revolve::gazebo::MotorPtr > &_motors,
     const std::vector< revolve::gazebo::SensorPtr > &_sensors)
-    : nextState_(nullptr)
-    , input_(new double[_sensors.size()])
-    , output_(new double[_motors.size()])
+    : DifferentialCPG(
+        _settings,
+        CPGBank::Find(_model->GetWorld()->Name()),
+        [_model]()
+        {
+          return _model->WorldPose();
+        },
+        _motors,
+        _sensors)
 {
   // Create transport node
   this->node_.reset(new gz::transport::Node());
@@ -52,6 +70,38 @@ DifferentialCPG::DifferentialCPG(
 //      "~/" + name + "/modify_diff_cpg", &DifferentialCPG::Modify,
 //      this);
 
+  if (this->evaluator_)
+  {
+    this->evaluator_->Advertise(this->node_, name);
+  }
+}
+
+/////////////////////////////////////////////////
+DifferentialCPG::DifferentialCPG(
+    const sdf::ElementPtr &_settings,
+    const CPGBankPtr &_bank,
+    const PoseSource &_pose,
+    const std::vector< revolve::gazebo::MotorPtr > &_motors,
+    const std::vector< revolve::gazebo::SensorPtr > &_sensors)
+    : integrator_(EULER_INTEGRATOR)
+    , dt_(0)
+    , substeps_(1)
+    , pose_(_pose)
+    , bestFitness_(-std::numeric_limits< double >::infinity())
+    , learning_(false)
+    , evaluations_(0)
+    , maxEvaluations_(100)
+    , initSamples_(10)
+    , acquisitionSamples_(256)
+    , evaluationRate_(30.0)
+    , exploration_(0.01)
+    , weightMin_(-1.0)
+    , weightMax_(1.0)
+    , startTime_(-1)
+    , rng_(std::random_device()())
+    , input_(new double[_sensors.size()])
+    , output_(new double[_motors.size()])
+{
   if (not _settings->HasElement("rv:brain"))
   {
     std::cerr << "No robot brain detected, this is probably an error."
@@ -60,6 +110,92 @@ DifferentialCPG::DifferentialCPG(
   }
 
   std::cout << _settings->GetDescription() << std::endl;
+
+  // Integration of the oscillators between two controller steps
+  auto brain = _settings->GetElement("rv:brain");
+  auto replay = true;
+  auto replayTolerance = 0.02;
+  if (brain->HasElement("rv:controller"))
+  {
+    auto controller = brain->GetElement("rv:controller");
+    if (controller->HasAttribute("integrator"))
+    {
+      this->integrator_ = DifferentialCPG::ParseIntegrator(
+          controller->GetAttribute("integrator")->GetAsString());
+    }
+    if (controller->HasAttribute("dt"))
+    {
+      controller->GetAttribute("dt")->Get(this->dt_);
+      this->dt_ = std::max(this->dt_, 0.0);
+    }
+    if (controller->HasAttribute("substeps"))
+    {
+      controller->GetAttribute("substeps")->Get(this->substeps_);
+      this->substeps_ = std::max(this->substeps_, 1u);
+    }
+    if (controller->HasAttribute("replay"))
+    {
+      controller->GetAttribute("replay")->Get(replay);
+    }
+    if (controller->HasAttribute("replay_tolerance"))
+    {
+      controller->GetAttribute("replay_tolerance")->Get(replayTolerance);
+    }
+  }
+
+  // Bayesian optimisation of the connection weights
+  auto lengthScale = 0.2;
+  auto noise = 1e-3;
+  auto metric = DISPLACEMENT_FITNESS;
+  if (brain->HasElement("rv:learner"))
+  {
+    auto learner = brain->GetElement("rv:learner");
+    if (learner->HasAttribute("max_evaluations"))
+    {
+      learner->GetAttribute("max_evaluations")->Get(this->maxEvaluations_);
+    }
+    if (learner->HasAttribute("init_samples"))
+    {
+      learner->GetAttribute("init_samples")->Get(this->initSamples_);
+    }
+    if (learner->HasAttribute("acquisition_samples"))
+    {
+      learner->GetAttribute("acquisition_samples")->Get(
+          this->acquisitionSamples_);
+      this->acquisitionSamples_ =
+          std::max(this->acquisitionSamples_, static_cast< size_t >(1));
+    }
+    if (learner->HasAttribute("evaluation_rate"))
+    {
+      learner->GetAttribute("evaluation_rate")->Get(this->evaluationRate_);
+    }
+    if (learner->HasAttribute("exploration"))
+    {
+      learner->GetAttribute("exploration")->Get(this->exploration_);
+    }
+    if (learner->HasAttribute("weight_min"))
+    {
+      learner->GetAttribute("weight_min")->Get(this->weightMin_);
+    }
+    if (learner->HasAttribute("weight_max"))
+    {
+      learner->GetAttribute("weight_max")->Get(this->weightMax_);
+    }
+    if (learner->HasAttribute("length_scale"))
+    {
+      learner->GetAttribute("length_scale")->Get(lengthScale);
+    }
+    if (learner->HasAttribute("noise"))
+    {
+      learner->GetAttribute("noise")->Get(noise);
+    }
+    if (learner->HasAttribute("fitness"))
+    {
+      metric = Evaluator::ParseMetric(
+          learner->GetAttribute("fitness")->GetAsString());
+    }
+  }
+
   auto motor = _settings->HasElement("rv:motor")
                ? _settings->GetElement("rv:motor")
                : sdf::ElementPtr();
@@ -113,14 +249,51 @@ DifferentialCPG::DifferentialCPG(
     }
   }
 
-  // Initialise array of neuron states for Update() method
-  this->nextState_ = new double[this->neurons_.size()];
+  this->Compile();
+
+  // Replay the outputs once the oscillators settled on their limit cycle
+  if (replay)
+  {
+    this->cycle_.reset(
+        new LimitCycle(this->neurons_.size() / 2, replayTolerance));
+  }
+
+  // Without evaluations the weights keep their configured values
+  auto numWeights = this->connections_.size() / 2;
+  if (this->maxEvaluations_ > 0 and numWeights > 0)
+  {
+    this->learning_ = true;
+    this->surrogate_.reset(
+        new GaussianProcess(numWeights, lengthScale, noise));
+    this->evaluator_.reset(new Evaluator(this->evaluationRate_));
+    this->evaluator_->SetMetric(metric);
+
+    std::uniform_real_distribution< double > uniform(0, 1);
+    this->parameters_.resize(numWeights);
+    for (auto &parameter : this->parameters_)
+    {
+      parameter = uniform(this->rng_);
+    }
+    this->bestParameters_ = this->parameters_;
+    this->ApplyParameters();
+  }
+
+  // Integrate together with the other robots if the world has a bank
+  this->bank_ = _bank;
+  if (this->bank_)
+  {
+    this->bank_->Add(this);
+  }
 }
 
 /////////////////////////////////////////////////
 DifferentialCPG::~DifferentialCPG()
 {
-  delete[] this->nextState_;
+  if (this->bank_)
+  {
+    this->bank_->Remove(this);
+  }
+
   delete[] this->input_;
   delete[] this->output_;
 }
@@ -134,6 +307,28 @@ void DifferentialCPG::Update(
 {
   boost::mutex::scoped_lock lock(this->networkMutex_);
 
+  // Evaluate the current weights on certain time limit
+  if (this->learning_)
+  {
+    auto power = 0.0;
+    for (const auto &motor: _motors)
+    {
+      power += motor->Power();
+    }
+    this->evaluator_->Update(this->pose_(), _time, power);
+    if (this->startTime_ < 0)
+    {
+      this->startTime_ = _time;
+      this->evaluator_->Reset();
+    }
+    else if ((_time - this->startTime_) > this->evaluationRate_)
+    {
+      this->Learn();
+      this->startTime_ = _time;
+      this->evaluator_->Reset();
+    }
+  }
+
   // Read sensor data and feed the neural network
   unsigned int p = 0;
   for (const auto &sensor : _sensors)
@@ -142,7 +337,16 @@ void DifferentialCPG::Update(
     p += sensor->Inputs();
   }
 
-  this->Step(_time, this->output_);
+  // A banked CPG is integrated and actuated at the end of the world update,
+  // unless it replays its limit cycle
+  auto replaying = this->cycle_ and this->cycle_->Converged();
+  if (not replaying and this->bank_ and
+      this->bank_->Submit(this, _motors, _step))
+  {
+    return;
+  }
+
+  this->Step(_step, this->output_);
 
   // Send new signals to the motors
   p = 0;
@@ -153,51 +357,377 @@ void DifferentialCPG::Update(
   }
 }
 
-void DifferentialCPG::Step(
-    const double _time,
-    double *_output)
+/////////////////////////////////////////////////
+void DifferentialCPG::Compile()
 {
-  auto i = 0;
+  auto numNeurons = this->neurons_.size();
+
+  // Number the neurons in the order of the register, which is also the order
+  // of the motor outputs
+  std::map< std::tuple< int, int, int >, size_t > indices;
+  this->bias_.clear();
+  this->gain_.clear();
+  this->state_.clear();
+  this->initialState_.clear();
   for (const auto &neuron : this->neurons_)
   {
     // The map key is representing x-, y-, and z-coordinates of a neuron and
     // map value represents bias, gain, and current state of the neuron.
-    int x, y, z;
-    std::tie(x, y, z) = neuron.first;
+    double bias, gain, state;
+    std::tie(bias, gain, state) = neuron.second;
+
+    indices[neuron.first] = this->bias_.size();
+    this->bias_.push_back(bias);
+    this->gain_.push_back(gain);
+    this->state_.push_back(state);
+    this->initialState_.push_back(state);
+  }
+
+  // Group the connections by their destination neuron
+  this->incoming_.assign(numNeurons + 1, 0);
+  for (const auto &connection : this->connections_)
+  {
+    int x1, y1, z1, x2, y2, z2;
+    std::tie(x1, y1, z1, x2, y2, z2) = connection.first;
+    ++this->incoming_[indices.at(std::make_tuple(x2, y2, z2)) + 1];
+  }
+  for (size_t i = 0; i < numNeurons; ++i)
+  {
+    this->incoming_[i + 1] += this->incoming_[i];
+  }
+
+  this->rates_.resize(4 * numNeurons);
+  this->stage_.resize(numNeurons);
+  this->stepSizes_.resize(numNeurons);
+
+  // The two directions of a connection share a learned weight with
+  // opposite signs, the direction to the larger coordinates is positive
+  std::map< std::pair< size_t, size_t >, size_t > pairs;
+  this->sources_.resize(this->connections_.size());
+  this->weights_.resize(this->connections_.size());
+  this->weightIndex_.resize(this->connections_.size());
+  this->weightSign_.resize(this->connections_.size());
+  std::vector< size_t > next(
+      this->incoming_.begin(), this->incoming_.end() - 1);
+  for (const auto &connection : this->connections_)
+  {
+    int x1, y1, z1, x2, y2, z2;
+    std::tie(x1, y1, z1, x2, y2, z2) = connection.first;
+    auto source = indices.at(std::make_tuple(x1, y1, z1));
+    auto destination = indices.at(std::make_tuple(x2, y2, z2));
+    auto k = next[destination]++;
+    this->sources_[k] = source;
+    this->weights_[k] = connection.second;
+
+    auto pair = std::make_pair(
+        std::min(source, destination), std::max(source, destination));
+    auto index = pairs.emplace(pair, pairs.size()).first->second;
+    this->weightIndex_[k] = index;
+    this->weightSign_[k] = source < destination ? 1.0 : -1.0;
+  }
+}
+
+/////////////////////////////////////////////////
+void DifferentialCPG::ApplyParameters()
+{
+  auto range = this->weightMax_ - this->weightMin_;
+  for (size_t k = 0; k < this->weights_.size(); ++k)
+  {
+    auto parameter = this->parameters_[this->weightIndex_[k]];
+    this->weights_[k] =
+        this->weightSign_[k] * (this->weightMin_ + parameter * range);
+  }
+
+  // Every evaluation starts from the same oscillator states
+  this->state_ = this->initialState_;
+  if (this->cycle_)
+  {
+    this->cycle_->Reset();
+  }
+  if (this->bank_)
+  {
+    this->bank_->Refresh(this);
+  }
+}
+
+/////////////////////////////////////////////////
+void DifferentialCPG::Learn()
+{
+  auto fitness = this->evaluator_->Fitness();
+  this->surrogate_->Add(this->parameters_.data(), fitness);
+  ++this->evaluations_;
+  if (fitness > this->bestFitness_)
+  {
+    this->bestFitness_ = fitness;
+    this->bestParameters_ = this->parameters_;
+  }
+
+  if (this->evaluations_ >= this->maxEvaluations_)
+  {
+    // Keep the best weights once the evaluations are spent
+    this->learning_ = false;
+    this->parameters_ = this->bestParameters_;
+  }
+  else if (this->evaluations_ < this->initSamples_)
+  {
+    std::uniform_real_distribution< double > uniform(0, 1);
+    for (auto &parameter : this->parameters_)
+    {
+      parameter = uniform(this->rng_);
+    }
+  }
+  else
+  {
+    this->Propose();
+  }
+
+  this->ApplyParameters();
+}
 
-    double biasA, gainA, stateA;
-    std::tie(biasA, gainA, stateA) = neuron.second;
+/////////////////////////////////////////////////
+void DifferentialCPG::Propose()
+{
+  auto dimensions = this->parameters_.size();
+  auto count = this->acquisitionSamples_;
+  this->candidates_.resize(count * dimensions);
+  this->candidateMean_.resize(count);
+  this->candidateVariance_.resize(count);
 
-    auto inputA = 0.f;
-    for (auto const &connection : this->connections_)
+  std::uniform_real_distribution< double > uniform(0, 1);
+  std::normal_distribution< double > normal(0, 1);
+  auto centre = this->bestParameters_;
+  auto spread = ACQUISITION_SPREAD;
+  auto bestImprovement = -1.0;
+  for (size_t round = 0; round < ACQUISITION_ROUNDS; ++round)
+  {
+    for (size_t c = 0; c < count; ++c)
     {
-      int x1, y1, z1, x2, y2, z2;
-      std::tie(x1, y1, z1, x2, y2, z2) = connection.first;
-      auto weightBA = connection.second;
+      auto candidate = this->candidates_.data() + c * dimensions;
+      for (size_t d = 0; d < dimensions; ++d)
+      {
+        // The first round explores half of its candidates globally
+        auto value = round == 0 and c % 2 == 0
+                     ? uniform(this->rng_)
+                     : centre[d] + spread * normal(this->rng_);
+        candidate[d] = std::min(std::max(value, 0.0), 1.0);
+      }
+    }
+
+    this->surrogate_->Predict(
+        this->candidates_.data(),
+        count,
+        this->candidateMean_.data(),
+        this->candidateVariance_.data());
 
-      if (x2 == x and y2 == y and z2 == z)
+    // Expected improvement over the best fitness so far
+    for (size_t c = 0; c < count; ++c)
+    {
+      auto sigma = std::sqrt(this->candidateVariance_[c]);
+      auto gain = this->candidateMean_[c] - this->bestFitness_ -
+                  this->exploration_;
+      auto improvement = std::max(gain, 0.0);
+      if (sigma > 0)
       {
-        auto input = std::get<2>(this->neurons_[{x1, y1, z1}]);
-        inputA += weightBA * input + biasA;
+        auto z = gain / sigma;
+        auto cdf = 0.5 * std::erfc(-z / std::sqrt(2.0));
+        auto pdf = std::exp(-0.5 * z * z) / std::sqrt(2.0 * M_PI);
+        improvement = gain * cdf + sigma * pdf;
+      }
+      if (improvement > bestImprovement)
+      {
+        bestImprovement = improvement;
+        auto candidate = this->candidates_.data() + c * dimensions;
+        this->parameters_.assign(candidate, candidate + dimensions);
       }
     }
 
-    this->nextState_[i] = stateA + (inputA * _time);
-    ++i;
+    centre = this->parameters_;
+    spread *= 0.25;
+  }
+}
+
+/////////////////////////////////////////////////
+CPGIntegrator DifferentialCPG::ParseIntegrator(const std::string &_name)
+{
+  if ("euler" == _name)
+  {
+    return EULER_INTEGRATOR;
+  }
+  if ("rk4" == _name)
+  {
+    return RK4_INTEGRATOR;
+  }
+  if ("semi_implicit" == _name)
+  {
+    return SEMI_IMPLICIT_INTEGRATOR;
   }
 
-  i = 0; auto j = 0;
-  for (auto &neuron : this->neurons_)
+  std::cerr << "Unknown CPG integrator `" << _name
+            << "`, expected `euler`, `rk4` or `semi_implicit`." << std::endl;
+  throw std::runtime_error("Robot brain error");
+}
+
+/////////////////////////////////////////////////
+void DifferentialCPG::Derivative(
+    const CPGArrays &_cpg,
+    const double *_state,
+    double *_rate)
+{
+  for (size_t i = 0; i < _cpg.neurons; ++i)
   {
-    double biasA, gainA, stateA;
-    std::tie(biasA, gainA, stateA) = neuron.second;
+    auto begin = _cpg.incoming[i];
+    auto end = _cpg.incoming[i + 1];
+
+    // Every incoming connection adds the bias of the neuron once
+    auto input = _cpg.bias[i] * (end - begin);
+    for (auto k = begin; k < end; ++k)
+    {
+      input += _cpg.weights[k] * _state[_cpg.sources[k]];
+    }
+    _rate[i] = input;
+  }
+}
 
-    neuron.second = {biasA, gainA, this->nextState_[i]};
-    if (i % 2 == 0)
+/////////////////////////////////////////////////
+void DifferentialCPG::Integrate(
+    const CPGIntegrator _integrator,
+    const unsigned int _steps,
+    const CPGArrays &_cpg)
+{
+  auto n = _cpg.neurons;
+  auto h = _cpg.step;
+  auto state = _cpg.state;
+  auto k1 = _cpg.rates;
+  auto k2 = k1 + n;
+  auto k3 = k2 + n;
+  auto k4 = k3 + n;
+  auto stage = _cpg.stage;
+  for (unsigned int s = 0; s < _steps; ++s)
+  {
+    switch (_integrator)
     {
-      _output[j] = this->nextState_[i];
-      j++;
+      case EULER_INTEGRATOR:
+      {
+        DifferentialCPG::Derivative(_cpg, state, k1);
+        for (size_t i = 0; i < n; ++i)
+        {
+          state[i] += h[i] * k1[i];
+        }
+        break;
+      }
+      case RK4_INTEGRATOR:
+      {
+        DifferentialCPG::Derivative(_cpg, state, k1);
+        for (size_t i = 0; i < n; ++i)
+        {
+          stage[i] = state[i] + 0.5 * h[i] * k1[i];
+        }
+        DifferentialCPG::Derivative(_cpg, stage, k2);
+        for (size_t i = 0; i < n; ++i)
+        {
+          stage[i] = state[i] + 0.5 * h[i] * k2[i];
+        }
+        DifferentialCPG::Derivative(_cpg, stage, k3);
+        for (size_t i = 0; i < n; ++i)
+        {
+          stage[i] = state[i] + h[i] * k3[i];
+        }
+        DifferentialCPG::Derivative(_cpg, stage, k4);
+        for (size_t i = 0; i < n; ++i)
+        {
+          state[i] += h[i] / 6.0 *
+                      (k1[i] + 2.0 * k2[i] + 2.0 * k3[i] + k4[i]);
+        }
+        break;
+      }
+      case SEMI_IMPLICIT_INTEGRATOR:
+      {
+        // Updating in place lets every neuron see the new states of the
+        // neurons before it, the B neuron of an oscillator comes before A
+        for (size_t i = 0; i < n; ++i)
+        {
+          auto begin = _cpg.incoming[i];
+          auto end = _cpg.incoming[i + 1];
+          auto input = _cpg.bias[i] * (end - begin);
+          for (auto k = begin; k < end; ++k)
+          {
+            input += _cpg.weights[k] * state[_cpg.sources[k]];
+          }
+          state[i] += h[i] * input;
+        }
+        break;
+      }
+      default:
+        break;
     }
-    ++i;
+  }
+}
+
+/////////////////////////////////////////////////
+unsigned int DifferentialCPG::SubSteps(const double _step) const
+{
+  // Split the controller step so that no sub-step exceeds `dt_`
+  auto steps = static_cast< double >(this->substeps_);
+  if (this->dt_ > 0)
+  {
+    steps = std::max(steps, std::ceil(_step / this->dt_));
+  }
+  return static_cast< unsigned int >(
+      std::min(steps, static_cast< double >(MAX_CPG_SUBSTEPS)));
+}
+
+/////////////////////////////////////////////////
+CPGArrays DifferentialCPG::Arrays()
+{
+  CPGArrays cpg;
+  cpg.neurons = this->state_.size();
+  cpg.incoming = this->incoming_.data();
+  cpg.sources = this->sources_.data();
+  cpg.weights = this->weights_.data();
+  cpg.bias = this->bias_.data();
+  cpg.step = this->stepSizes_.data();
+  cpg.state = this->state_.data();
+  cpg.rates = this->rates_.data();
+  cpg.stage = this->stage_.data();
+  return cpg;
+}
+
+/////////////////////////////////////////////////
+void DifferentialCPG::Step(
+    const double _step,
+    double *_output)
+{
+  if (this->cycle_ and this->cycle_->Converged())
+  {
+    this->cycle_->Replay(_step, _output);
+    return;
+  }
+
+  if (_step > 0)
+  {
+    auto steps = this->SubSteps(_step);
+    std::fill(
+        this->stepSizes_.begin(), this->stepSizes_.end(), _step / steps);
+    DifferentialCPG::Integrate(this->integrator_, steps, this->Arrays());
+  }
+
+  this->Output(this->state_.data(), _output);
+  if (this->cycle_)
+  {
+    this->cycle_->Record(_step, _output);
+  }
+}
+
+/////////////////////////////////////////////////
+void DifferentialCPG::Output(
+    const double *_state,
+    double *_output) const
+{
+  // The B neuron of every oscillator drives its motor
+  size_t j = 0;
+  for (size_t i = 0; i < this->state_.size(); i += 2)
+  {
+    _output[j] = _state[i];
+    j++;
   }
 }
@@ -23,17 +23,78 @@
 #define REVOLVE_DIFFERENTIALCPG_H_
 
 #include <map>
+#include <memory>
+#include <random>
+#include <string>
 #include <tuple>
+#include <vector>
 
 #include "Brain.h"
+#include "CPGBank.h"
+#include "Evaluator.h"
+#include "GaussianProcess.h"
+#include "LimitCycle.h"
+
+/// Upper bound of the integration sub-steps per controller step
+#define MAX_CPG_SUBSTEPS 256
 
 namespace revolve
 {
   namespace gazebo
   {
+    /// \brief Fixed-step integration schemes of the CPG
+    enum CPGIntegrator
+    {
+      /// \brief Explicit Euler
+      EULER_INTEGRATOR,
+
+      /// \brief Classic fourth order Runge-Kutta
+      RK4_INTEGRATOR,
+
+      /// \brief Euler in which every neuron already sees the new states of
+      /// the neurons before it, so the A and B neurons of an oscillator are
+      /// updated symplectically
+      SEMI_IMPLICIT_INTEGRATOR
+    };
+
+    /// \brief Views of the neuron and connection arrays of one CPG, or of
+    /// many CPGs concatenated, for the integration kernel
+    struct CPGArrays
+    {
+      /// \brief Number of neurons
+      size_t neurons;
+
+      /// \brief Start of the incoming connections of every neuron, followed
+      /// by their number
+      const size_t *incoming;
+
+      /// \brief Source neuron of every connection
+      const size_t *sources;
+
+      /// \brief Weight of every connection
+      const double *weights;
+
+      /// \brief Bias of every neuron
+      const double *bias;
+
+      /// \brief Sub-step size of every neuron
+      const double *step;
+
+      /// \brief State of every neuron
+      double *state;
+
+      /// \brief Four derivatives per neuron
+      double *rates;
+
+      /// \brief One intermediate state per neuron
+      double *stage;
+    };
+
     class DifferentialCPG
         : public Brain
     {
+      friend class CPGBank;
+
       /// \brief Constructor
       /// \param[in] _modelName Name of the robot
       /// \param[in] _node The brain node
@@ -45,6 +106,21 @@ namespace revolve
           const std::vector< MotorPtr > &_motors,
           const std::vector< SensorPtr > &_sensors);
 
+      /// \brief Constructor for a robot outside of a simulation, which does
+      /// not publish its fitness
+      /// \param[in] _settings Robot configuration with the `rv:brain` and
+      /// `rv:motor` elements
+      /// \param[in] _bank Bank to integrate in, null to step by itself
+      /// \param[in] _pose Pose of the robot, from which the fitness follows
+      /// \param[in] _motors Motors receiving the outputs
+      /// \param[in] _sensors Sensors feeding the inputs
+      public: DifferentialCPG(
+          const sdf::ElementPtr &_settings,
+          const CPGBankPtr &_bank,
+          const PoseSource &_pose,
+          const std::vector< MotorPtr > &_motors,
+          const std::vector< SensorPtr > &_sensors);
+
       /// \brief Destructor
       public: virtual ~DifferentialCPG();
 
@@ -59,10 +135,67 @@ namespace revolve
           const double _time,
           const double _step);
 
+      /// \brief Advances the CPG by one controller step
+      /// \param[in] _step Time covered by the step
+      /// \param[out] _output Motor outputs
       protected: void Step(
-          const double _time,
+          const double _step,
           double *_output);
 
+      /// \brief Parses the name of an integration scheme
+      /// \param[in] _name `euler`, `rk4` or `semi_implicit`
+      public: static CPGIntegrator ParseIntegrator(const std::string &_name);
+
+      /// \brief Adds the fitness of the current weights to the surrogate
+      /// and moves on to the next weights
+      private: void Learn();
+
+      /// \brief Proposes the weights with the highest expected improvement
+      /// \details Every round predicts a batch of candidates at once, the
+      /// first around random points and the best weights so far, the others
+      /// ever closer around the best candidate of the previous round.
+      private: void Propose();
+
+      /// \brief Sets the connection weights from `parameters_` and restarts
+      /// the oscillators
+      private: void ApplyParameters();
+
+      /// \brief Number of sub-steps of a controller step
+      /// \param[in] _step Time covered by the step
+      protected: unsigned int SubSteps(const double _step) const;
+
+      /// \brief Views of the arrays of this CPG
+      protected: CPGArrays Arrays();
+
+      /// \brief Copies the motor outputs out of the neuron states
+      /// \param[in] _state State of every neuron of this CPG
+      /// \param[out] _output Motor outputs
+      protected: void Output(
+          const double *_state,
+          double *_output) const;
+
+      /// \brief Integrates one or many concatenated CPGs
+      /// \param[in] _integrator Integration scheme
+      /// \param[in] _steps Number of sub-steps
+      /// \param[in,out] _cpg Arrays, the states are updated in place
+      public: static void Integrate(
+          const CPGIntegrator _integrator,
+          const unsigned int _steps,
+          const CPGArrays &_cpg);
+
+      /// \brief Computes the rate of change of every neuron
+      /// \param[in] _cpg Arrays of the CPGs
+      /// \param[in] _state State of every neuron
+      /// \param[out] _rate Derivative of every neuron
+      private: static void Derivative(
+          const CPGArrays &_cpg,
+          const double *_state,
+          double *_rate);
+
+      /// \brief Compiles the coordinate registers into the indexed arrays
+      /// that `Step()` iterates over
+      protected: void Compile();
+
       /// \brief Register of motor IDs and their x,y-coordinates
       protected: std::map< std::string, std::tuple< int, int > >
           positions_;
@@ -80,8 +213,131 @@ namespace revolve
       protected: std::map< std::tuple< int, int, int, int, int, int >,
                            double > connections_;
 
-      /// \brief Used to determine the next state array
-      private: double *nextState_;
+      /// \brief Bias of every neuron, in the order of `neurons_`
+      private: std::vector< double > bias_;
+
+      /// \brief Gain of every neuron, in the order of `neurons_`
+      private: std::vector< double > gain_;
+
+      /// \brief Current state of every neuron, in the order of `neurons_`
+      private: std::vector< double > state_;
+
+      /// \brief Start of the incoming connections of every neuron in
+      /// `sources_` and `weights_`, followed by the number of connections
+      private: std::vector< size_t > incoming_;
+
+      /// \brief Index of the source neuron of every incoming connection
+      private: std::vector< size_t > sources_;
+
+      /// \brief Weight of every incoming connection
+      private: std::vector< double > weights_;
+
+      /// \brief Integration scheme, from the `integrator` attribute of
+      /// `rv:controller`
+      private: CPGIntegrator integrator_;
+
+      /// \brief Largest internal step, from the `dt` attribute of
+      /// `rv:controller`, or zero to only use `substeps_`
+      private: double dt_;
+
+      /// \brief Minimal number of sub-steps per controller step, from the
+      /// `substeps` attribute of `rv:controller`
+      private: unsigned int substeps_;
+
+      /// \brief Parameter of every incoming connection in `weights_`, the
+      /// two directions of a connection share one parameter
+      private: std::vector< size_t > weightIndex_;
+
+      /// \brief Sign of every incoming connection in `weights_`, opposite
+      /// for the two directions of a connection
+      private: std::vector< double > weightSign_;
+
+      /// \brief State of every neuron at the start of an evaluation
+      private: std::vector< double > initialState_;
+
+      /// \brief Pose of the robot whose displacement is the fitness
+      private: PoseSource pose_;
+
+      /// \brief Fitness evaluator of the current weights
+      private: EvaluatorPtr evaluator_;
+
+      /// \brief Surrogate of the fitness of the weights
+      private: std::unique_ptr< GaussianProcess > surrogate_;
+
+      /// \brief Weights under evaluation, scaled to [0, 1]
+      private: std::vector< double > parameters_;
+
+      /// \brief Best weights so far, scaled to [0, 1]
+      private: std::vector< double > bestParameters_;
+
+      /// \brief Candidates of an acquisition round, one after another
+      private: std::vector< double > candidates_;
+
+      /// \brief Posterior mean of every candidate
+      private: std::vector< double > candidateMean_;
+
+      /// \brief Posterior variance of every candidate
+      private: std::vector< double > candidateVariance_;
+
+      /// \brief Fitness of `bestParameters_`
+      private: double bestFitness_;
+
+      /// \brief Whether the weights are still being optimised
+      private: bool learning_;
+
+      /// \brief Number of evaluated weights
+      private: size_t evaluations_;
+
+      /// \brief Number of evaluations, from the `max_evaluations` attribute
+      /// of `rv:learner`, zero to keep the weights fixed
+      private: size_t maxEvaluations_;
+
+      /// \brief Number of random weights before the surrogate proposes any,
+      /// from the `init_samples` attribute of `rv:learner`
+      private: size_t initSamples_;
+
+      /// \brief Candidates per acquisition round, from the
+      /// `acquisition_samples` attribute of `rv:learner`
+      private: size_t acquisitionSamples_;
+
+      /// \brief Duration of an evaluation, from the `evaluation_rate`
+      /// attribute of `rv:learner`
+      private: double evaluationRate_;
+
+      /// \brief Minimal improvement over the best fitness that counts, from
+      /// the `exploration` attribute of `rv:learner`
+      private: double exploration_;
+
+      /// \brief Lower bound of a weight, from `weight_min`
+      private: double weightMin_;
+
+      /// \brief Upper bound of a weight, from `weight_max`
+      private: double weightMax_;
+
+      /// \brief Start of the current evaluation
+      private: double startTime_;
+
+      /// \brief Random number engine for the candidates
+      private: std::mt19937 rng_;
+
+      /// \brief Converged cycle of the outputs, from the `replay` attribute
+      /// of `rv:controller`, or null to always integrate
+      /// \details The CPG has no sensory feedback, so its trajectory only
+      /// changes with the weights and the cycle is reset when they change.
+      private: std::unique_ptr< LimitCycle > cycle_;
+
+      /// \brief Bank integrating this CPG together with the other robots in
+      /// the world, null if the world has none
+      protected: CPGBankPtr bank_;
+
+      /// \brief Derivatives of the Runge-Kutta stages, four per neuron
+      private: std::vector< double > rates_;
+
+      /// \brief Intermediate state of a Runge-Kutta stage
+      private: std::vector< double > stage_;
+
+      /// \brief Sub-step size of every neuron
+      private: std::vector< double > stepSizes_;
 
       /// \brief One input state for each input neuron
       private: double *input_;
@@ -19,20 +19,34 @@
  *
  */
 
+#include <algorithm>
 #include <cmath>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
 
 #include "Evaluator.h"
 
+namespace gz = gazebo;
+
 using namespace revolve::gazebo;
 
+/// Smallest z-component of the up axis of an upright robot, 45 degrees of
+/// tilt
+static const double UPRIGHT_COSINE = std::sqrt(0.5);
+
 /////////////////////////////////////////////////
 Evaluator::Evaluator(const double _evaluationRate)
+    : metric_(DISPLACEMENT_FITNESS)
+    , lastTime_(-1)
 {
   assert(_evaluationRate > 0 and "`_evaluationRate` should be greater than 0");
   this->evaluationRate_ = _evaluationRate;
 
   this->currentPosition_.Reset();
   this->previousPosition_.Reset();
+  this->Reset();
 }
 
 /////////////////////////////////////////////////
@@ -42,21 +56,219 @@ Evaluator::~Evaluator() = default;
 void Evaluator::Reset()
 {
   this->previousPosition_ = this->currentPosition_;
+
+  this->duration_ = 0;
+  this->pathLength_ = 0;
+  this->headingCos_ = 0;
+  this->headingSin_ = 0;
+  this->headings_ = 0;
+  this->energy_ = 0;
+  this->upright_ = 0;
 }
 
 /////////////////////////////////////////////////
 double Evaluator::Fitness()
 {
-  auto dS = std::sqrt(std::pow(this->previousPosition_.Pos().X() -
-                               this->currentPosition_.Pos().X(), 2) +
-                      std::pow(this->previousPosition_.Pos().Y() -
-                               this->currentPosition_.Pos().Y(), 2));
-  this->previousPosition_ = this->currentPosition_;
-  return dS / this->evaluationRate_;
+  auto dS = this->Displacement();
+  auto meanSpeed = this->duration_ > 0
+                   ? this->pathLength_ / this->duration_
+                   : 0.0;
+  auto headingVariance = this->headings_ > 0
+                         ? 1.0 - std::hypot(this->headingCos_,
+                                            this->headingSin_) /
+                                 this->headings_
+                         : 0.0;
+
+  auto fitness = 0.0;
+  switch (this->metric_)
+  {
+    case DISPLACEMENT_FITNESS:
+      fitness = dS / this->evaluationRate_;
+      break;
+    case PATH_LENGTH_FITNESS:
+      fitness = this->pathLength_;
+      break;
+    case SPEED_FITNESS:
+      fitness = meanSpeed;
+      break;
+    case HEADING_FITNESS:
+      fitness = 1.0 - headingVariance;
+      break;
+    case ENERGY_FITNESS:
+      fitness = -this->energy_;
+      break;
+    case UPRIGHT_FITNESS:
+      fitness = this->duration_ > 0 ? this->upright_ / this->duration_ : 0.0;
+      break;
+    default:
+      break;
+  }
+
+  this->metrics_.set_robot(this->robot_);
+  auto time = this->metrics_.mutable_time();
+  auto seconds = std::max(this->lastTime_, 0.0);
+  time->set_sec(static_cast< int >(seconds));
+  time->set_nsec(static_cast< int >((seconds - std::floor(seconds)) * 1e9));
+  this->metrics_.set_metric(Evaluator::MetricName(this->metric_));
+  this->metrics_.set_fitness(fitness);
+  this->metrics_.set_duration(this->duration_);
+  this->metrics_.set_displacement(dS);
+  this->metrics_.set_path_length(this->pathLength_);
+  this->metrics_.set_mean_speed(meanSpeed);
+  this->metrics_.set_heading_variance(headingVariance);
+  this->metrics_.set_energy(this->energy_);
+  this->metrics_.set_time_upright(this->upright_);
+  if (this->publisher_)
+  {
+    this->publisher_->Publish(this->metrics_);
+  }
+
+  this->Reset();
+  return fitness;
+}
+
+/////////////////////////////////////////////////
+double Evaluator::Displacement() const
+{
+  return std::sqrt(std::pow(this->previousPosition_.Pos().X() -
+                            this->currentPosition_.Pos().X(), 2) +
+                   std::pow(this->previousPosition_.Pos().Y() -
+                            this->currentPosition_.Pos().Y(), 2));
 }
 
 /////////////////////////////////////////////////
-void Evaluator::Update(const ignition::math::Pose3d &_pose)
+double Evaluator::Bound(
+    const double _remaining,
+    const double _speed) const
 {
+  const auto duration = this->duration_ + _remaining;
+  const auto meanSpeed = this->duration_ > 0
+                         ? this->pathLength_ / this->duration_
+                         : 0.0;
+  const auto distance = std::max(_speed, meanSpeed) * _remaining;
+
+  // Updates left at the update rate so far, all along the mean heading
+  const auto updates = this->duration_ > 0
+                       ? this->headings_ * _remaining / this->duration_
+                       : 0.0;
+
+  switch (this->metric_)
+  {
+    case DISPLACEMENT_FITNESS:
+      return (this->Displacement() + distance) / this->evaluationRate_;
+    case PATH_LENGTH_FITNESS:
+      return this->pathLength_ + distance;
+    case SPEED_FITNESS:
+      return duration > 0 ? (this->pathLength_ + distance) / duration
+                          : _speed;
+    case HEADING_FITNESS:
+      return this->headings_ > 0
+             ? (std::hypot(this->headingCos_, this->headingSin_) + updates) /
+               (this->headings_ + updates)
+             : 1.0;
+    case ENERGY_FITNESS:
+      // The work of the joints never decreases
+      return -this->energy_;
+    case UPRIGHT_FITNESS:
+      return duration > 0 ? (this->upright_ + _remaining) / duration : 1.0;
+    default:
+      return std::numeric_limits< double >::infinity();
+  }
+}
+
+/////////////////////////////////////////////////
+void Evaluator::Update(
+    const ignition::math::Pose3d &_pose,
+    const double _time,
+    const double _power)
+{
+  // The first update only sets the time, so that no interval is counted
+  // from before the robot existed
+  auto dt = this->lastTime_ >= 0 ? std::max(_time - this->lastTime_, 0.0)
+                                 : 0.0;
+  if (this->lastTime_ >= 0)
+  {
+    this->pathLength_ += std::hypot(
+        _pose.Pos().X() - this->currentPosition_.Pos().X(),
+        _pose.Pos().Y() - this->currentPosition_.Pos().Y());
+  }
+  this->lastTime_ = _time;
   this->currentPosition_ = _pose;
+
+  this->duration_ += dt;
+  this->energy_ += _power * dt;
+
+  auto yaw = _pose.Rot().Yaw();
+  this->headingCos_ += std::cos(yaw);
+  this->headingSin_ += std::sin(yaw);
+  ++this->headings_;
+
+  auto up = _pose.Rot().RotateVector(ignition::math::Vector3d(0, 0, 1));
+  if (up.Z() >= UPRIGHT_COSINE)
+  {
+    this->upright_ += dt;
+  }
+}
+
+/////////////////////////////////////////////////
+void Evaluator::SetMetric(const FitnessMetric _metric)
+{
+  this->metric_ = _metric;
+}
+
+/////////////////////////////////////////////////
+void Evaluator::Advertise(
+    const ::gazebo::transport::NodePtr &_node,
+    const std::string &_robot)
+{
+  this->robot_ = _robot;
+  this->publisher_ = _node->Advertise< msgs::Fitness >(
+      "~/" + _robot + "/fitness");
+}
+
+/////////////////////////////////////////////////
+const revolve::msgs::Fitness &Evaluator::Metrics() const
+{
+  return this->metrics_;
+}
+
+/////////////////////////////////////////////////
+FitnessMetric Evaluator::ParseMetric(const std::string &_name)
+{
+  for (auto metric : {DISPLACEMENT_FITNESS, PATH_LENGTH_FITNESS,
+                      SPEED_FITNESS, HEADING_FITNESS, ENERGY_FITNESS,
+                      UPRIGHT_FITNESS})
+  {
+    if (Evaluator::MetricName(metric) == _name)
+    {
+      return metric;
+    }
+  }
+
+  std::cerr << "Unknown fitness metric `" << _name << "`, expected "
+            << "`displacement`, `path_length`, `speed`, `heading`, "
+            << "`energy` or `upright`." << std::endl;
+  throw std::runtime_error("Robot brain error");
+}
+
+/////////////////////////////////////////////////
+std::string Evaluator::MetricName(const FitnessMetric _metric)
+{
+  switch (_metric)
+  {
+    case DISPLACEMENT_FITNESS:
+      return "displacement";
+    case PATH_LENGTH_FITNESS:
+      return "path_length";
+    case SPEED_FITNESS:
+      return "speed";
+    case HEADING_FITNESS:
+      return "heading";
+    case ENERGY_FITNESS:
+      return "energy";
+    case UPRIGHT_FITNESS:
+      return "upright";
+    default:
+      return "";
+  }
 }
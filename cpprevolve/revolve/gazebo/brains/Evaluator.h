@@ -20,14 +20,51 @@
 #ifndef REVOLVEBRAIN_BRAIN_EVALUATOR_H
 #define REVOLVEBRAIN_BRAIN_EVALUATOR_H
 
+#include <functional>
+#include <string>
+
 #include <boost/shared_ptr.hpp>
 
 #include <gazebo/common/common.hh>
+#include <gazebo/gazebo.hh>
+
+#include <revolve/msgs/fitness.pb.h>
 
 namespace revolve
 {
   namespace gazebo
   {
+    /// \brief Metrics an evaluator can return as fitness
+    enum FitnessMetric
+    {
+      /// \brief Straight-line displacement over the evaluation rate
+      DISPLACEMENT_FITNESS,
+
+      /// \brief Distance travelled
+      PATH_LENGTH_FITNESS,
+
+      /// \brief Distance travelled over time
+      SPEED_FITNESS,
+
+      /// \brief One minus the circular variance of the heading
+      HEADING_FITNESS,
+
+      /// \brief Negative mechanical work of the joints
+      ENERGY_FITNESS,
+
+      /// \brief Fraction of the time spent upright
+      UPRIGHT_FITNESS
+    };
+
+    /// \brief Returns the current pose of the evaluated robot, its world
+    /// pose in a simulation
+    typedef std::function< ignition::math::Pose3d () > PoseSource;
+
+    /// \brief Accumulates the fitness metrics of an evaluation in constant
+    /// time and memory per update.
+    /// \details `Fitness()` ends the evaluation, fills the `Fitness`
+    /// message with all metrics, publishes it if `Advertise()` was called
+    /// and returns the selected metric.
     class Evaluator
     {
       /// \brief Constructor
@@ -43,9 +80,53 @@ namespace revolve
       /// \return A fitness value according to a given formula
       public: double Fitness();
 
+      /// \brief Distance covered in the horizontal plane since the last
+      /// `Reset()` or `Fitness()`
+      public: double Displacement() const;
+
+      /// \brief Optimistic bound on the fitness of the current evaluation
+      /// \details The bound assumes the rest of the evaluation goes as well
+      /// as it can for the selected metric: the robot heads straight away
+      /// at `_speed`, or its current mean speed if that is higher, keeps
+      /// the mean heading so far, stays upright and spends no more energy.
+      /// It is never below what `Fitness()` would return right now.
+      /// \param[in] _remaining Time left in the evaluation
+      /// \param[in] _speed Horizontal speed credited for the time left
+      /// \return Highest fitness the evaluation can still reach
+      public: double Bound(
+          const double _remaining,
+          const double _speed) const;
+
       /// \brief Update the position
       /// \param[in] _pose Current position of a robot
-      public: void Update(const ignition::math::Pose3d &_pose);
+      /// \param[in] _time Current time
+      /// \param[in] _power Mechanical power of the joints
+      public: void Update(
+          const ignition::math::Pose3d &_pose,
+          const double _time,
+          const double _power = 0);
+
+      /// \brief Selects the metric `Fitness()` returns
+      public: void SetMetric(const FitnessMetric _metric);
+
+      /// \brief Publishes the metrics of every evaluation on
+      /// `~/<robot>/fitness`
+      /// \param[in] _node Transport node of the brain
+      /// \param[in] _robot Name of the robot
+      public: void Advertise(
+          const ::gazebo::transport::NodePtr &_node,
+          const std::string &_robot);
+
+      /// \brief Metrics of the last evaluation
+      public: const msgs::Fitness &Metrics() const;
+
+      /// \brief Parses the name of a metric
+      /// \param[in] _name `displacement`, `path_length`, `speed`, `heading`,
+      /// `energy` or `upright`
+      public: static FitnessMetric ParseMetric(const std::string &_name);
+
+      /// \brief Name of a metric
+      public: static std::string MetricName(const FitnessMetric _metric);
 
       /// \brief Previous position of a robot
       private: ignition::math::Pose3d previousPosition_;
@@ -55,6 +136,42 @@ namespace revolve
 
       /// \brief
       private: double evaluationRate_;
+
+      /// \brief Metric returned by `Fitness()`
+      private: FitnessMetric metric_;
+
+      /// \brief Time of the last update, negative before the first one
+      private: double lastTime_;
+
+      /// \brief Time covered since the start of the evaluation
+      private: double duration_;
+
+      /// \brief Distance travelled since the start of the evaluation
+      private: double pathLength_;
+
+      /// \brief Sum of the cosine of the heading
+      private: double headingCos_;
+
+      /// \brief Sum of the sine of the heading
+      private: double headingSin_;
+
+      /// \brief Number of headings in the sums
+      private: size_t headings_;
+
+      /// \brief Mechanical work of the joints
+      private: double energy_;
+
+      /// \brief Time spent upright
+      private: double upright_;
+
+      /// \brief Metrics of the last evaluation
+      private: msgs::Fitness metrics_;
+
+      /// \brief Name of the robot in the published metrics
+      private: std::string robot_;
+
+      /// \brief Publisher of the metrics, null unless advertised
+      private: ::gazebo::transport::PublisherPtr publisher_;
     };
   }
 }
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Weight matrix of small networks with kernels specialized
+ *              for the number of columns.
+ * Date: October 16, 2026
+ *
+ */
+
+#include <cassert>
+
+#include "FixedMatrix.h"
+
+using namespace revolve::gazebo;
+
+/////////////////////////////////////////////////
+template < unsigned int COLUMNS >
+static void MultiplyFixed(
+    const double *_matrix,
+    const unsigned int *_rows,
+    const unsigned int _count,
+    const double *_x,
+    double *_y)
+{
+  // A local copy lets the compiler keep the inputs in registers
+  double x[COLUMNS];
+  for (unsigned int c = 0; c < COLUMNS; ++c)
+  {
+    x[c] = _x[c];
+  }
+
+  for (unsigned int k = 0; k < _count; ++k)
+  {
+    const auto i = _rows ? _rows[k] : k;
+    const double *row = _matrix + i * COLUMNS;
+    double sum = 0;
+    for (unsigned int c = 0; c < COLUMNS; ++c)
+    {
+      sum += row[c] * x[c];
+    }
+    _y[i] = sum;
+  }
+}
+
+/// \brief Kernels by number of columns
+static const FixedMatrix::Kernel KERNELS[FixedMatrix::MAX_COLUMNS + 1] = {
+    nullptr,
+    MultiplyFixed< 1 >,
+    MultiplyFixed< 2 >,
+    MultiplyFixed< 3 >,
+    MultiplyFixed< 4 >,
+    MultiplyFixed< 5 >,
+    MultiplyFixed< 6 >,
+    MultiplyFixed< 7 >,
+    MultiplyFixed< 8 >,
+    MultiplyFixed< 9 >,
+    MultiplyFixed< 10 >,
+    MultiplyFixed< 11 >,
+    MultiplyFixed< 12 >,
+    MultiplyFixed< 13 >,
+    MultiplyFixed< 14 >,
+    MultiplyFixed< 15 >,
+    MultiplyFixed< 16 >};
+
+/////////////////////////////////////////////////
+FixedMatrix::FixedMatrix()
+    : rows_(0)
+    , cols_(0)
+    , kernel_(nullptr)
+{
+}
+
+/////////////////////////////////////////////////
+FixedMatrix::FixedMatrix(const SparseMatrix &_sparse)
+    : rows_(_sparse.Rows())
+    , cols_(_sparse.Cols())
+{
+  assert(this->cols_ <= MAX_COLUMNS);
+  this->kernel_ = KERNELS[this->cols_];
+  this->values_.assign(this->rows_ * this->cols_, 0);
+
+  const auto &offsets = _sparse.Offsets();
+  const auto &columns = _sparse.Columns();
+  const auto &values = _sparse.Values();
+  for (unsigned int i = 0; i < this->rows_; ++i)
+  {
+    for (auto k = offsets[i]; k < offsets[i + 1]; ++k)
+    {
+      this->values_[i * this->cols_ + columns[k]] = values[k];
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void FixedMatrix::Multiply(
+    const double *_x,
+    double *_y) const
+{
+  if (this->kernel_)
+  {
+    this->kernel_(this->values_.data(), nullptr, this->rows_, _x, _y);
+  }
+}
+
+/////////////////////////////////////////////////
+void FixedMatrix::MultiplyRows(
+    const unsigned int *_rows,
+    const unsigned int _count,
+    const double *_x,
+    double *_y) const
+{
+  if (this->kernel_)
+  {
+    this->kernel_(this->values_.data(), _rows, _count, _x, _y);
+  }
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Weight matrix of small networks with kernels specialized
+ *              for the number of columns.
+ * Date: October 16, 2026
+ *
+ */
+
+#ifndef REVOLVE_GAZEBO_BRAIN_FIXEDMATRIX_H_
+#define REVOLVE_GAZEBO_BRAIN_FIXEDMATRIX_H_
+
+#include <vector>
+
+#include "SparseMatrix.h"
+
+namespace revolve
+{
+  namespace gazebo
+  {
+    /// \brief Row-major weight matrix of a network with at most
+    /// `MAX_COLUMNS` neurons.
+    /// \details The kernels are templates instantiated for every column
+    /// count from 1 to `MAX_COLUMNS`, and the one matching the matrix is
+    /// picked from a table when the matrix is built. The inner loop over the
+    /// columns therefore has a compile-time trip count and is fully
+    /// unrolled, which removes the loop overhead that dominates the tiny
+    /// networks most robots have.
+    class FixedMatrix
+    {
+      /// \brief Largest number of columns with a specialized kernel
+      public: static const unsigned int MAX_COLUMNS = 16;
+
+      /// \brief Kernel computing the rows listed in `_rows`, or the first
+      /// `_count` rows if `_rows` is null
+      public: typedef void (*Kernel)(
+          const double *_matrix,
+          const unsigned int *_rows,
+          const unsigned int _count,
+          const double *_x,
+          double *_y);
+
+      /// \brief Constructor
+      public: FixedMatrix();
+
+      /// \brief Builds a copy of a sparse matrix with at most `MAX_COLUMNS`
+      /// columns
+      public: explicit FixedMatrix(const SparseMatrix &_sparse);
+
+      /// \brief Computes `_y = A * _x`
+      /// \param[in] _x Input vector of `Cols()` elements
+      /// \param[out] _y Output vector of `Rows()` elements
+      public: void Multiply(
+          const double *_x,
+          double *_y) const;
+
+      /// \brief Computes `_y[r] = A[r] * _x` for the rows `r` in `_rows`
+      /// \param[in] _rows Rows to compute
+      /// \param[in] _count Number of rows in `_rows`
+      /// \param[in] _x Input vector of `Cols()` elements
+      /// \param[out] _y Output vector, indexed by row
+      public: void MultiplyRows(
+          const unsigned int *_rows,
+          const unsigned int _count,
+          const double *_x,
+          double *_y) const;
+
+      /// \return Number of rows
+      public: unsigned int Rows() const { return this->rows_; }
+
+      /// \return Number of columns
+      public: unsigned int Cols() const { return this->cols_; }
+
+      /// \brief Number of rows
+      private: unsigned int rows_;
+
+      /// \brief Number of columns
+      private: unsigned int cols_;
+
+      /// \brief Weights, `rows_ * cols_` elements
+      private: std::vector< double > values_;
+
+      /// \brief Kernel for `cols_` columns
+      private: Kernel kernel_;
+    };
+  }
+}
+
+#endif  // REVOLVE_GAZEBO_BRAIN_FIXEDMATRIX_H_
@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Gaussian process regression with a Cholesky factor that
+ *              grows by one row per observation.
+ * Date: October 16, 2026
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "GaussianProcess.h"
+
+using namespace revolve::gazebo;
+
+/// Smallest pivot of the Cholesky factor, relative to the signal variance
+static const double MIN_PIVOT = 1e-10;
+
+/////////////////////////////////////////////////
+GaussianProcess::GaussianProcess(
+    const size_t _dimensions,
+    const double _lengthScale,
+    const double _noise)
+    : dimensions_(_dimensions)
+    , lengthScale_(_lengthScale)
+    , noise_(_noise)
+    , offset_(0)
+    , scale_(1)
+{
+}
+
+/////////////////////////////////////////////////
+size_t GaussianProcess::Size() const
+{
+  return this->values_.size();
+}
+
+/////////////////////////////////////////////////
+size_t GaussianProcess::Dimensions() const
+{
+  return this->dimensions_;
+}
+
+/////////////////////////////////////////////////
+double GaussianProcess::Kernel(
+    const double *_a,
+    const double *_b) const
+{
+  auto squared = 0.0;
+  for (size_t d = 0; d < this->dimensions_; ++d)
+  {
+    auto difference = _a[d] - _b[d];
+    squared += difference * difference;
+  }
+
+  // Matern 5/2 with unit signal variance
+  auto r = std::sqrt(5.0 * squared) / this->lengthScale_;
+  return (1.0 + r + r * r / 3.0) * std::exp(-r);
+}
+
+/////////////////////////////////////////////////
+void GaussianProcess::Add(
+    const double *_point,
+    const double _value)
+{
+  auto n = this->Size();
+  auto point = this->points_.data();
+
+  // The new row of the factor solves L * row = k(X, x)
+  this->cholesky_.resize((n + 1) * (n + 2) / 2);
+  auto row = this->cholesky_.data() + n * (n + 1) / 2;
+  auto squared = 0.0;
+  for (size_t i = 0; i < n; ++i)
+  {
+    auto Li = this->cholesky_.data() + i * (i + 1) / 2;
+    auto sum = this->Kernel(point + i * this->dimensions_, _point);
+    for (size_t j = 0; j < i; ++j)
+    {
+      sum -= Li[j] * row[j];
+    }
+    row[i] = sum / Li[i];
+    squared += row[i] * row[i];
+  }
+  row[n] = std::sqrt(std::max(1.0 + this->noise_ - squared, MIN_PIVOT));
+
+  this->points_.insert(
+      this->points_.end(), _point, _point + this->dimensions_);
+  this->values_.push_back(_value);
+
+  this->SolveWeights();
+}
+
+/////////////////////////////////////////////////
+void GaussianProcess::SolveWeights()
+{
+  auto n = this->Size();
+
+  // Standardise the observations
+  auto sum = 0.0;
+  for (const auto value : this->values_)
+  {
+    sum += value;
+  }
+  this->offset_ = sum / n;
+  auto squared = 0.0;
+  for (const auto value : this->values_)
+  {
+    squared += (value - this->offset_) * (value - this->offset_);
+  }
+  this->scale_ = n > 1 ? std::sqrt(squared / (n - 1)) : 0.0;
+  if (this->scale_ < MIN_PIVOT)
+  {
+    this->scale_ = 1.0;
+  }
+
+  // Forward substitution L * z = y, then back substitution L^T * w = z
+  this->weights_.resize(n);
+  auto L = this->cholesky_.data();
+  auto w = this->weights_.data();
+  for (size_t i = 0; i < n; ++i)
+  {
+    auto Li = L + i * (i + 1) / 2;
+    auto value = (this->values_[i] - this->offset_) / this->scale_;
+    for (size_t j = 0; j < i; ++j)
+    {
+      value -= Li[j] * w[j];
+    }
+    w[i] = value / Li[i];
+  }
+  for (size_t i = n; i-- > 0;)
+  {
+    auto value = w[i];
+    for (size_t j = i + 1; j < n; ++j)
+    {
+      value -= L[j * (j + 1) / 2 + i] * w[j];
+    }
+    w[i] = value / L[i * (i + 1) / 2 + i];
+  }
+}
+
+/////////////////////////////////////////////////
+void GaussianProcess::Predict(
+    const double *_points,
+    const size_t _count,
+    double *_mean,
+    double *_variance)
+{
+  auto n = this->Size();
+  if (n == 0)
+  {
+    std::fill(_mean, _mean + _count, 0.0);
+    std::fill(_variance, _variance + _count, 1.0);
+    return;
+  }
+
+  // Kernel between every observation and every point, with the points
+  // contiguous so that the solve below runs over the whole batch at once
+  this->cross_.resize(n * _count);
+  this->solved_.resize(n * _count);
+  auto cross = this->cross_.data();
+  auto solved = this->solved_.data();
+  for (size_t i = 0; i < n; ++i)
+  {
+    auto observation = this->points_.data() + i * this->dimensions_;
+    for (size_t c = 0; c < _count; ++c)
+    {
+      cross[i * _count + c] =
+          this->Kernel(observation, _points + c * this->dimensions_);
+    }
+  }
+
+  // Mean is k^T * w, variance is k(x, x) - |L^-1 * k|^2
+  std::fill(_mean, _mean + _count, 0.0);
+  std::fill(_variance, _variance + _count, 1.0);
+  auto L = this->cholesky_.data();
+  for (size_t i = 0; i < n; ++i)
+  {
+    auto Li = L + i * (i + 1) / 2;
+    auto v = solved + i * _count;
+    auto k = cross + i * _count;
+    auto w = this->weights_[i];
+    for (size_t c = 0; c < _count; ++c)
+    {
+      v[c] = k[c];
+      _mean[c] += w * k[c];
+    }
+    for (size_t j = 0; j < i; ++j)
+    {
+      auto vj = solved + j * _count;
+      auto Lij = Li[j];
+      for (size_t c = 0; c < _count; ++c)
+      {
+        v[c] -= Lij * vj[c];
+      }
+    }
+    auto inverse = 1.0 / Li[i];
+    for (size_t c = 0; c < _count; ++c)
+    {
+      v[c] *= inverse;
+      _variance[c] -= v[c] * v[c];
+    }
+  }
+
+  auto variance = this->scale_ * this->scale_;
+  for (size_t c = 0; c < _count; ++c)
+  {
+    _mean[c] = this->offset_ + this->scale_ * _mean[c];
+    _variance[c] = variance * std::max(_variance[c], 0.0);
+  }
+}
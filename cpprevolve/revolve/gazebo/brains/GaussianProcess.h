@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Gaussian process regression with a Cholesky factor that
+ *              grows by one row per observation.
+ * Date: October 16, 2026
+ *
+ */
+
+#ifndef REVOLVE_GAZEBO_BRAIN_GAUSSIANPROCESS_H_
+#define REVOLVE_GAZEBO_BRAIN_GAUSSIANPROCESS_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace revolve
+{
+  namespace gazebo
+  {
+    /// \brief Gaussian process surrogate of a fitness function on the unit
+    /// hypercube, with a Matern 5/2 kernel.
+    /// \details The Cholesky factor of the kernel matrix is extended by one
+    /// row for every observation, which costs O(n^2) instead of the O(n^3)
+    /// of a new factorisation. The observations are standardised, so the
+    /// kernel parameters do not depend on the scale of the fitness.
+    class GaussianProcess
+    {
+      /// \brief Constructor
+      /// \param[in] _dimensions Number of coordinates of a point
+      /// \param[in] _lengthScale Length scale of the kernel
+      /// \param[in] _noise Observation noise, relative to the signal
+      public: GaussianProcess(
+          const size_t _dimensions,
+          const double _lengthScale,
+          const double _noise);
+
+      /// \brief Adds an observation
+      /// \param[in] _point `Dimensions()` coordinates
+      /// \param[in] _value Observed value at `_point`
+      public: void Add(
+          const double *_point,
+          const double _value);
+
+      /// \brief Predicts the value of a batch of points
+      /// \param[in] _points `_count` points, one after another
+      /// \param[in] _count Number of points
+      /// \param[out] _mean Posterior mean of every point
+      /// \param[out] _variance Posterior variance of every point
+      public: void Predict(
+          const double *_points,
+          const size_t _count,
+          double *_mean,
+          double *_variance);
+
+      /// \brief Number of observations
+      public: size_t Size() const;
+
+      /// \brief Number of coordinates of a point
+      public: size_t Dimensions() const;
+
+      /// \brief Kernel between two points
+      private: double Kernel(
+          const double *_a,
+          const double *_b) const;
+
+      /// \brief Solves the weights of the observations for the posterior
+      /// mean with the current factor
+      private: void SolveWeights();
+
+      /// \brief Number of coordinates of a point
+      private: size_t dimensions_;
+
+      /// \brief Length scale of the kernel
+      private: double lengthScale_;
+
+      /// \brief Observation noise, added to the diagonal
+      private: double noise_;
+
+      /// \brief Observed points, one after another
+      private: std::vector< double > points_;
+
+      /// \brief Observed values
+      private: std::vector< double > values_;
+
+      /// \brief Lower triangular Cholesky factor, row i starts at
+      /// i * (i + 1) / 2
+      private: std::vector< double > cholesky_;
+
+      /// \brief Weights of the observations in the posterior mean
+      private: std::vector< double > weights_;
+
+      /// \brief Mean of the observed values
+      private: double offset_;
+
+      /// \brief Standard deviation of the observed values
+      private: double scale_;
+
+      /// \brief Kernel between the predicted points and the observations,
+      /// observation-major
+      private: std::vector< double > cross_;
+
+      /// \brief Forward solve of `cross_`, observation-major
+      private: std::vector< double > solved_;
+    };
+  }
+}
+
+#endif  // REVOLVE_GAZEBO_BRAIN_GAUSSIANPROCESS_H_
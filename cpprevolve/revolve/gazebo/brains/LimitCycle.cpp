@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Detects that periodic outputs have settled and replays one
+ *              recorded period of them.
+ * Date: October 16, 2026
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "LimitCycle.h"
+
+using namespace revolve::gazebo;
+
+/// Number of consecutive agreeing cycles before the outputs are replayed
+static const size_t CONVERGED_CYCLES = 3;
+
+/// Smallest amplitude that counts as an oscillation
+static const double MIN_AMPLITUDE = 1e-6;
+
+/// Samples of a cycle reserved up front, so that recording does not grow
+/// the buffers one step at a time
+static const size_t RESERVED_SAMPLES = 512;
+
+/////////////////////////////////////////////////
+LimitCycle::LimitCycle(
+    const size_t _outputs,
+    const double _tolerance)
+    : outputs_(_outputs)
+    , tolerance_(_tolerance)
+{
+  this->offsets_.reserve(RESERVED_SAMPLES);
+  this->samples_.reserve(RESERVED_SAMPLES * _outputs);
+  this->tableOffsets_.reserve(RESERVED_SAMPLES);
+  this->table_.reserve(RESERVED_SAMPLES * _outputs);
+  this->Reset();
+}
+
+/////////////////////////////////////////////////
+void LimitCycle::Reset()
+{
+  this->clock_ = 0;
+  this->previous_ = 0;
+  this->started_ = false;
+  this->crossing_ = -1;
+  this->centre_ = 0;
+  this->minimum_ = 0;
+  this->maximum_ = 0;
+  this->period_ = 0;
+  this->amplitude_ = 0;
+  this->stableCycles_ = 0;
+  this->offsets_.clear();
+  this->samples_.clear();
+  this->converged_ = false;
+  this->tableOffsets_.clear();
+  this->table_.clear();
+  this->tablePeriod_ = 0;
+  this->phase_ = 0;
+}
+
+/////////////////////////////////////////////////
+bool LimitCycle::Converged() const
+{
+  return this->converged_;
+}
+
+/////////////////////////////////////////////////
+void LimitCycle::Record(
+    const double _step,
+    const double *_outputs)
+{
+  if (this->outputs_ == 0 or this->converged_)
+  {
+    return;
+  }
+
+  this->clock_ += _step;
+  auto value = _outputs[0];
+  if (not this->started_)
+  {
+    this->started_ = true;
+    this->previous_ = this->minimum_ = this->maximum_ = value;
+    return;
+  }
+
+  // Until the first crossing, the middle of the values so far is the level
+  if (this->crossing_ < 0)
+  {
+    this->centre_ = 0.5 * (this->minimum_ + this->maximum_);
+  }
+
+  if (this->previous_ < this->centre_ and value >= this->centre_)
+  {
+    auto time = this->clock_ - _step +
+                _step * (this->centre_ - this->previous_) /
+                (value - this->previous_);
+    if (this->crossing_ >= 0)
+    {
+      auto period = time - this->crossing_;
+      auto amplitude = this->maximum_ - this->minimum_;
+      auto stable =
+          this->period_ > 0 and amplitude > MIN_AMPLITUDE and
+          std::fabs(period - this->period_) <= this->tolerance_ * period and
+          std::fabs(amplitude - this->amplitude_) <=
+              this->tolerance_ * amplitude;
+      this->stableCycles_ = stable ? this->stableCycles_ + 1 : 0;
+      this->period_ = period;
+      this->amplitude_ = amplitude;
+
+      if (this->stableCycles_ >= CONVERGED_CYCLES and
+          not this->offsets_.empty())
+      {
+        // The cycle that just ended becomes the table, and the current
+        // value lies just after the crossing at its start. It is copied
+        // rather than swapped, so neither buffer loses its capacity.
+        this->converged_ = true;
+        this->tableOffsets_ = this->offsets_;
+        this->table_ = this->samples_;
+        this->tablePeriod_ = period;
+        this->phase_ = this->clock_ - time;
+        return;
+      }
+    }
+
+    this->centre_ = 0.5 * (this->minimum_ + this->maximum_);
+    this->minimum_ = this->maximum_ = value;
+    this->crossing_ = time;
+    this->offsets_.clear();
+    this->samples_.clear();
+  }
+
+  this->minimum_ = std::min(this->minimum_, value);
+  this->maximum_ = std::max(this->maximum_, value);
+  this->previous_ = value;
+
+  if (this->crossing_ >= 0)
+  {
+    this->offsets_.push_back(this->clock_ - this->crossing_);
+    this->samples_.insert(
+        this->samples_.end(), _outputs, _outputs + this->outputs_);
+  }
+}
+
+/////////////////////////////////////////////////
+void LimitCycle::Replay(
+    const double _step,
+    double *_outputs)
+{
+  this->phase_ = std::fmod(this->phase_ + _step, this->tablePeriod_);
+
+  // Interpolate between the samples around the phase, wrapping from the
+  // last sample of the period to the first one of the next
+  auto count = this->tableOffsets_.size();
+  auto next = static_cast< size_t >(
+      std::upper_bound(
+          this->tableOffsets_.begin(),
+          this->tableOffsets_.end(),
+          this->phase_) - this->tableOffsets_.begin());
+  auto before = next == 0 ? count - 1 : next - 1;
+  auto after = next == count ? 0 : next;
+
+  auto start = this->tableOffsets_[before];
+  auto end = this->tableOffsets_[after];
+  auto phase = this->phase_;
+  if (next == 0)
+  {
+    start -= this->tablePeriod_;
+  }
+  if (next == count)
+  {
+    end += this->tablePeriod_;
+  }
+  auto weight = end > start ? (phase - start) / (end - start) : 0.0;
+
+  auto a = this->table_.data() + before * this->outputs_;
+  auto b = this->table_.data() + after * this->outputs_;
+  for (size_t o = 0; o < this->outputs_; ++o)
+  {
+    _outputs[o] = a[o] + weight * (b[o] - a[o]);
+  }
+}
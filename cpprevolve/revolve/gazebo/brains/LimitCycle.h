@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Detects that periodic outputs have settled and replays one
+ *              recorded period of them.
+ * Date: October 16, 2026
+ *
+ */
+
+#ifndef REVOLVE_GAZEBO_BRAIN_LIMITCYCLE_H_
+#define REVOLVE_GAZEBO_BRAIN_LIMITCYCLE_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace revolve
+{
+  namespace gazebo
+  {
+    /// \brief Recorder of the outputs of an oscillator that has settled on
+    /// its limit cycle.
+    /// \details The cycles are delimited by the upward crossings of the
+    /// first output through the middle of its previous cycle, interpolated
+    /// between two steps. Once the period and the amplitude of a number of
+    /// consecutive cycles agree within the tolerance, the last cycle is kept
+    /// as a table and `Replay()` looks the outputs up by their phase.
+    class LimitCycle
+    {
+      /// \brief Constructor
+      /// \param[in] _outputs Number of outputs per step
+      /// \param[in] _tolerance Relative tolerance of period and amplitude
+      public: LimitCycle(
+          const size_t _outputs,
+          const double _tolerance);
+
+      /// \brief Forgets the recorded cycles, for example after the
+      /// oscillator changed
+      public: void Reset();
+
+      /// \brief Whether the outputs have settled and can be replayed
+      public: bool Converged() const;
+
+      /// \brief Records the outputs of a step
+      /// \param[in] _step Time covered by the step
+      /// \param[in] _outputs Outputs at the end of the step
+      public: void Record(
+          const double _step,
+          const double *_outputs);
+
+      /// \brief Advances the phase and writes the outputs of the table
+      /// \param[in] _step Time covered by the step
+      /// \param[out] _outputs Outputs at the end of the step
+      public: void Replay(
+          const double _step,
+          double *_outputs);
+
+      /// \brief Number of outputs per step
+      private: size_t outputs_;
+
+      /// \brief Relative tolerance of period and amplitude
+      private: double tolerance_;
+
+      /// \brief Time recorded since the last `Reset()`
+      private: double clock_;
+
+      /// \brief First output of the previous step
+      private: double previous_;
+
+      /// \brief Whether `previous_` was recorded
+      private: bool started_;
+
+      /// \brief Time of the last crossing, negative before the first one
+      private: double crossing_;
+
+      /// \brief Level of the crossings, the middle of the previous cycle
+      private: double centre_;
+
+      /// \brief Minimum of the first output in the current cycle
+      private: double minimum_;
+
+      /// \brief Maximum of the first output in the current cycle
+      private: double maximum_;
+
+      /// \brief Period of the previous cycle, zero if unknown
+      private: double period_;
+
+      /// \brief Amplitude of the previous cycle
+      private: double amplitude_;
+
+      /// \brief Number of consecutive cycles that agreed
+      private: size_t stableCycles_;
+
+      /// \brief Time since the crossing of every sample of the current cycle
+      private: std::vector< double > offsets_;
+
+      /// \brief Outputs of every sample of the current cycle
+      private: std::vector< double > samples_;
+
+      /// \brief Whether the table is complete
+      private: bool converged_;
+
+      /// \brief Time since the crossing of every sample in the table
+      private: std::vector< double > tableOffsets_;
+
+      /// \brief Outputs of every sample in the table
+      private: std::vector< double > table_;
+
+      /// \brief Period of the table
+      private: double tablePeriod_;
+
+      /// \brief Current phase in the table, in time since a crossing
+      private: double phase_;
+    };
+  }
+}
+
+#endif  // REVOLVE_GAZEBO_BRAIN_LIMITCYCLE_H_
@@ -18,13 +18,15 @@
 */
 
 #include <algorithm>
+#include <cctype>
 #include <cmath>
-#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <map>
-#include <set>
-#include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "NeuralNetwork.h"
@@ -35,18 +37,31 @@ namespace gz = gazebo;
 
 using namespace revolve::gazebo;
 
+/// \brief Layer of a neuron while the network is built
+enum neuronLayer
+{
+  INPUT_LAYER,
+  OUTPUT_LAYER,
+  HIDDEN_LAYER
+};
+
 /// Internal helper function to build neuron params
 /////////////////////////////////////////////////
 void neuronHelper(
     double *params,
     unsigned int *types,
-    sdf::ElementPtr neuron);
+    const revolve::msgs::Neuron &neuron);
 
+/// Internal helper functions to read the network description
 /////////////////////////////////////////////////
-void neuronHelper(
-    double *params,
-    unsigned int *types,
-    const revolve::msgs::Neuron &neuron);
+revolve::msgs::NeuralNetwork networkFromSdf(const sdf::ElementPtr &_settings);
+
+/////////////////////////////////////////////////
+revolve::msgs::NeuralNetwork networkFromPayload(
+    const sdf::ElementPtr &_payload);
+
+/////////////////////////////////////////////////
+std::string decodeBase64(const std::string &_text);
 
 /////////////////////////////////////////////////
 NeuralNetwork::NeuralNetwork(
@@ -54,11 +69,11 @@ NeuralNetwork::NeuralNetwork(
     const sdf::ElementPtr &_settings,
     const std::vector< MotorPtr > &_motors,
     const std::vector< SensorPtr > &_sensors)
-    : flipState_(false)
-    , nInputs_(0)
-    , nOutputs_(0)
-    , nHidden_(0)
-    , nNonInputs_(0)
+    : modified_(false)
+    , substeps_(1)
+    , lastTime_(std::numeric_limits< double >::quiet_NaN())
+    , accuracy_(EXACT)
+    , flipState_(false)
 {
   // Create transport node
   this->node_.reset(new gz::transport::Node());
@@ -70,107 +85,142 @@ NeuralNetwork::NeuralNetwork(
       "~/" + name + "/modify_neural_network", &NeuralNetwork::Modify,
       this);
 
-  // Initialize weights, input and states to zero by default
-  std::memset(this->inputWeights_, 0, sizeof(this->inputWeights_));
-  std::memset(this->outputWeights_, 0, sizeof(this->outputWeights_));
-  std::memset(this->hiddenWeights_, 0, sizeof(this->hiddenWeights_));
-  std::memset(this->state1_, 0, sizeof(this->state1_));
-  std::memset(this->state2_, 0, sizeof(this->state2_));
-  std::memset(this->input_, 0, sizeof(this->input_));
+  auto controller_settings = _settings->GetElement("rv:controller");
+  if (controller_settings->HasAttribute("accuracy"))
+  {
+    this->accuracy_ = Activations::ParseAccuracy(
+        controller_settings->GetAttribute("accuracy")->GetAsString());
+  }
+  if (controller_settings->HasAttribute("substeps"))
+  {
+    controller_settings->GetAttribute("substeps")->Get(this->substeps_);
+    this->substeps_ = std::max(this->substeps_, 1u);
+  }
 
-  // We now setup the neural network and its parameters. The end result
-  // of this operation should be that we can iterate/update all sensors in
-  // a straightforward manner, likewise for the motors. We therefore first
-  // create a map of all neurons, telling us how many there are for each
-  // type, and what their properties are. We then iterate all sensors and
-  // motors, creating the adequate neurons in place as we do so.
+  // A network embedded as a `revolve.msgs.NeuralNetwork` message is decoded
+  // in one go, the individual SDF elements are only walked without one.
+  auto layout = std::make_shared< Layout >();
+  if (controller_settings->HasAttribute("precision"))
+  {
+    layout->precision = CompactMatrix::ParsePrecision(
+        controller_settings->GetAttribute("precision")->GetAsString());
+  }
+  NeuralNetwork::Build(
+      *layout,
+      controller_settings->HasElement("rv:network")
+      ? networkFromPayload(controller_settings->GetElement("rv:network"))
+      : networkFromSdf(_settings),
+      _motors,
+      _sensors);
+  NeuralNetwork::Compile(*layout);
+  this->published_ = layout;
+
+  // Record the state of every neuron to `<trace>/<robot name>.rvtrace`
+  if (controller_settings->HasAttribute("trace"))
+  {
+    size_t capacity = DEFAULT_TRACE_CAPACITY;
+    if (controller_settings->HasAttribute("trace_capacity"))
+    {
+      controller_settings->GetAttribute("trace_capacity")->Get(capacity);
+    }
+    this->recorder_.reset(new TraceRecorder(
+        controller_settings->GetAttribute("trace")->GetAsString() + "/" +
+        name + ".rvtrace",
+        capacity));
+  }
 
-  // Map of ID to neuron element
-  // neuron.id ---> sdf_element
-  std::map< std::string, sdf::ElementPtr > neuronMap;
-  std::map< std::string, std::vector<sdf::ElementPtr> > neuronPartIdMap;
+  // Join the batched evaluation if the world plugin enabled it
+  this->pool_ = BrainPool::Find(_model->GetWorld()->Name());
+  this->Adopt(layout);
+}
 
-  // List of all hidden neurons (ids) for convenience
-  std::vector< std::string > hiddenNeurons;
+/////////////////////////////////////////////////
+NeuralNetwork::NeuralNetwork(
+    const revolve::msgs::NeuralNetwork &_network,
+    const std::vector< MotorPtr > &_motors,
+    const std::vector< SensorPtr > &_sensors)
+    : modified_(false)
+    , substeps_(1)
+    , lastTime_(std::numeric_limits< double >::quiet_NaN())
+    , accuracy_(EXACT)
+    , flipState_(false)
+{
+  auto layout = std::make_shared< Layout >();
+  NeuralNetwork::Build(*layout, _network, _motors, _sensors);
+  NeuralNetwork::Compile(*layout);
+  this->published_ = layout;
+  this->Adopt(layout);
+}
 
-  // Set for tracking all collected input/output neurons (ids)
-  std::set< std::string > toProcess;
+/////////////////////////////////////////////////
+NeuralNetwork::~NeuralNetwork()
+{
+  if (this->pool_)
+  {
+    this->pool_->Remove(this);
+  }
+}
 
-  auto controller_settings = _settings->GetElement("rv:controller");
+/////////////////////////////////////////////////
+NeuralNetwork::Layout::Layout()
+    : useDense(false)
+    , useFixed(false)
+    , precision(DOUBLE_WEIGHTS)
+    , useCompact(false)
+    , acyclic(false)
+    , largestBatch(0)
+    , nextKey(0)
+    , nInputs(0)
+    , nOutputs(0)
+    , nHidden(0)
+    , nNonInputs(0)
+{
+}
 
-  // Fetch the first neuron; note the HasElement call is necessary to
-  // prevent SDF from complaining if no neurons are present.
-  auto neuron = controller_settings->HasElement("rv:neuron")
-                ? controller_settings->GetElement("rv:neuron")
-                : sdf::ElementPtr();
-  while (neuron)
+/////////////////////////////////////////////////
+void NeuralNetwork::Build(
+    Layout &_layout,
+    const revolve::msgs::NeuralNetwork &_network,
+    const std::vector< MotorPtr > &_motors,
+    const std::vector< SensorPtr > &_sensors)
+{
+  // We now setup the neural network and its parameters. The end result
+  // of this operation should be that we can iterate/update all sensors in
+  // a straightforward manner, likewise for the motors. Every neuron ID is
+  // resolved to its index in the message once, after that the neurons are
+  // only handled by index.
+  const auto numNeurons = static_cast< unsigned int >(_network.neuron_size());
+  const auto unassigned = std::numeric_limits< unsigned int >::max();
+
+  std::unordered_map< std::string, unsigned int > indices(numNeurons);
+  std::unordered_map< std::string, std::vector< unsigned int > > parts;
+  std::vector< unsigned int > layers(numNeurons);
+  std::vector< unsigned int > positions(numNeurons, unassigned);
+  for (unsigned int i = 0; i < numNeurons; ++i)
   {
-    if (not neuron->HasAttribute("layer") or not neuron->HasAttribute("id"))
+    const auto &neuron = _network.neuron(i);
+    if (not indices.emplace(neuron.id(), i).second)
     {
-      std::cerr << "Missing required neuron attributes (id or layer). '"
-                << std::endl;
+      std::cerr << "Duplicate neuron ID '" << neuron.id() << "'" << std::endl;
       throw std::runtime_error("Robot brain error");
     }
-    auto layer = neuron->GetAttribute("layer")->GetAsString();
-    auto neuronId = neuron->GetAttribute("id")->GetAsString();
-    auto neuronPartId = neuron->GetAttribute("part_id")->GetAsString();
 
-    if (this->layerMap_.count(neuronId) == 1)
-    {
-      std::cerr << "Duplicate neuron ID '" << neuronId << "'" << std::endl;
-      throw std::runtime_error("Robot brain error");
-    }
-
-    this->layerMap_[neuronId] = layer;
-    neuronMap[neuronId] = neuron;
-
-    if (neuronPartIdMap.find(neuronPartId) == neuronPartIdMap.end()) {
-        neuronPartIdMap[neuronPartId] = std::vector<sdf::ElementPtr>();
-    }
-    neuronPartIdMap[neuronPartId].push_back(neuron);
-
-    // INPUT LAYER
+    const auto &layer = neuron.layer();
     if ("input" == layer)
     {
-      if (this->nInputs_ >= MAX_INPUT_NEURONS)
-      {
-        std::cerr << "The number of input neurons(" << (nInputs_ + 1)
-                  << ") is greater than the maximum allowed one ("
-                  << MAX_INPUT_NEURONS << ")" << std::endl;
-        throw std::runtime_error("Robot brain error");
-      }
-
-      toProcess.insert(neuronId);
-      ++(this->nInputs_);
+      layers[i] = INPUT_LAYER;
+      ++(_layout.nInputs);
     }
-    // OUTPUT LAYER
     else if ("output" == layer)
     {
-      if (this->nOutputs_ >= MAX_OUTPUT_NEURONS)
-      {
-        std::cerr << "The number of output neurons(" << (nOutputs_ + 1)
-                  << ") is greater than the maximum allowed  ("
-                  << MAX_OUTPUT_NEURONS << ")"<< std::endl;
-        throw std::runtime_error("Robot brain error");
-      }
-
-      toProcess.insert(neuronId);
-      ++(this->nOutputs_);
+      layers[i] = OUTPUT_LAYER;
+      ++(_layout.nOutputs);
     }
-    // HIDDEN LAYER
     else if ("hidden" == layer)
     {
-      if (hiddenNeurons.size() >= MAX_HIDDEN_NEURONS)
-      {
-        std::cerr << "The number of hidden neurons("
-                  << (hiddenNeurons.size() + 1)
-                  << ") is greater than the maximum allowed one ("
-                  << MAX_HIDDEN_NEURONS << ")" << std::endl;
-        throw std::runtime_error("Robot brain error");
-      }
-
-      hiddenNeurons.push_back(neuronId);
-      ++(this->nHidden_);
+      // Hidden neurons are numbered in the order they are listed
+      layers[i] = HIDDEN_LAYER;
+      positions[i] = _layout.nHidden++;
     }
     else
     {
@@ -178,48 +228,60 @@ NeuralNetwork::NeuralNetwork(
       throw std::runtime_error("Robot brain error");
     }
 
-    neuron = neuron->GetNextElement("rv:neuron");
+    parts[neuron.partid()].push_back(i);
   }
 
-  // Create motor output neurons at the correct position
-  // We iterate a part's motors and just assign every
-  // neuron we find in order.
-  unsigned int outputsIndex = 0;
-  for (const auto &motor : _motors)
+  // All neuron counts are known at this point, so size the network storage
+  // from them instead of reserving space for a fixed maximum.
+  _layout.nNonInputs = _layout.nOutputs + _layout.nHidden;
+  _layout.types.resize(_layout.nNonInputs, 0);
+  _layout.params.resize(_layout.nNonInputs * MAX_NEURON_PARAMS, 0);
+  for (unsigned int i = 0; i < _layout.nInputs + _layout.nNonInputs; ++i)
+  {
+    _layout.keys.push_back(_layout.nextKey++);
+  }
+
+  // Takes the next `_count` neurons of a layer from the neurons of a part,
+  // in the order they are listed, and gives them consecutive positions.
+  auto assign = [&](
+      const std::string &_partId,
+      const unsigned int _layer,
+      const unsigned int _count,
+      unsigned int &_position)
   {
-    std::string partId = motor->PartId();
-    auto details = neuronPartIdMap.find(partId);
-    if (details == neuronPartIdMap.end())
+    auto part = parts.find(_partId);
+    if (part == parts.end())
     {
-      std::cerr << "Required output neuron " << partId
-                << " for motor could not be located" << std::endl;
-      throw std::runtime_error("Robot brain error");
+      return false;
     }
 
-    const auto &neuron_list = details->second;
-    auto neuron_iter = neuron_list.cbegin();
-
-    for (unsigned int i = 0, l = motor->Outputs(); i < l; ++i)
+    const auto &neurons = part->second;
+    size_t k = 0;
+    for (unsigned int i = 0; i < _count; ++i, ++k)
     {
-        while (not ((*neuron_iter)->GetAttribute("layer")->GetAsString() == "output"))
-        {
-            ++neuron_iter;
-            if (neuron_iter == neuron_list.cend())
-            {
-                std::cerr << "Required input neuron " << partId
-                          << " for sensor could not be located" << std::endl;
-                throw std::runtime_error("Robot brain error");
-            }
-        }
-      std::string neuronId = (*neuron_iter)->GetAttribute("id")->GetAsString();
+      while (k < neurons.size() and layers[neurons[k]] not_eq _layer)
+      {
+        ++k;
+      }
+      if (k == neurons.size())
+      {
+        return false;
+      }
+      positions[neurons[k]] = _position++;
+    }
+    return true;
+  };
 
-      neuronHelper(&this->params_[outputsIndex * MAX_NEURON_PARAMS],
-                   &this->types_[outputsIndex],
-                   *neuron_iter);
-      this->positionMap_[neuronId] = outputsIndex;
-      toProcess.erase(neuronId);
-      ++outputsIndex;
-      ++neuron_iter;
+  // Create motor output neurons at the correct position. We iterate a
+  // part's motors and just assign every neuron we find in order.
+  unsigned int outputsIndex = 0;
+  for (const auto &motor : _motors)
+  {
+    if (not assign(motor->PartId(), OUTPUT_LAYER, motor->Outputs(), outputsIndex))
+    {
+      std::cerr << "Required output neuron " << motor->PartId()
+                << " for motor could not be located" << std::endl;
+      throw std::runtime_error("Robot brain error");
     }
   }
 
@@ -227,51 +289,28 @@ NeuralNetwork::NeuralNetwork(
   unsigned int inputsIndex = 0;
   for (const auto &sensor : _sensors)
   {
-    auto partId = sensor->PartId();
-    auto details = neuronPartIdMap.find(partId);
-    if (details == neuronPartIdMap.end())
+    if (not assign(sensor->PartId(), INPUT_LAYER, sensor->Inputs(), inputsIndex))
     {
-      std::cerr << "Required input neuron list " << partId
+      std::cerr << "Required input neuron " << sensor->PartId()
                 << " for sensor could not be located" << std::endl;
       throw std::runtime_error("Robot brain error");
     }
-    const auto &neuron_list = details->second;
-    auto neuron_iter = neuron_list.cbegin();
-
-    for (unsigned int i = 0, l = sensor->Inputs(); i < l; ++i)
-    {
-      while (not ((*neuron_iter)->GetAttribute("layer")->GetAsString() == "input"))
-      {
-          ++neuron_iter;
-          if (neuron_iter == neuron_list.cend())
-          {
-              std::cerr << "Required input neuron " << partId
-                        << " for sensor could not be located" << std::endl;
-              throw std::runtime_error("Robot brain error");
-          }
-      }
-      std::string neuronId = (*neuron_iter)->GetAttribute("id")->GetAsString();
-
-      // Input neurons can currently not have a type, so
-      // there is no need to process it.
-      this->positionMap_[neuronId] = inputsIndex;
-      toProcess.erase(neuronId);
-      ++inputsIndex;
-      ++neuron_iter;
-    }
   }
 
   // Check if there are any input / output neurons which have not
   // yet been processed. This is an error - every input / output
   // neuron should be connected to at least a virtual motor / sensor.
-  if (not toProcess.empty())
+  if (std::count(positions.begin(), positions.end(), unassigned))
   {
     std::cerr << "The following input / output neurons were"
         " defined, but not attached to any sensor / motor:" << std::endl;
 
-    for (auto it = toProcess.begin(); it not_eq toProcess.end(); ++it)
+    for (unsigned int i = 0; i < numNeurons; ++i)
     {
-      std::cerr << (*it) << std::endl;
+      if (positions[i] == unassigned)
+      {
+        std::cerr << _network.neuron(i).id() << std::endl;
+      }
     }
 
     std::cerr << "Create virtual sensor and motors for input / output"
@@ -279,140 +318,286 @@ NeuralNetwork::NeuralNetwork(
     throw std::runtime_error("Robot brain error");
   }
 
-  // Add hidden neurons
-  outputsIndex = 0;
-  for (const auto &neuronId : hiddenNeurons)
+  // Column of every neuron in the state vector, which holds inputs first,
+  // then outputs, then hidden neurons. Input neurons can currently not have
+  // a type, so there is no need to process it.
+  std::vector< unsigned int > columns(numNeurons);
+  for (unsigned int i = 0; i < numNeurons; ++i)
   {
-    // Position relative to hidden neurons
-    this->positionMap_[neuronId] = outputsIndex;
+    const auto &neuron = _network.neuron(i);
+    columns[i] = positions[i];
+    if (layers[i] == OUTPUT_LAYER)
+    {
+      columns[i] += _layout.nInputs;
+    }
+    else if (layers[i] == HIDDEN_LAYER)
+    {
+      columns[i] += _layout.nInputs + _layout.nOutputs;
+    }
 
-    // Offset with output neurons within params / types
-    auto pos = this->nOutputs_ + outputsIndex;
-    neuronHelper(&this->params_[pos * MAX_NEURON_PARAMS],
-                 &this->types_[pos],
-                 neuronMap[neuronId]);
-    ++outputsIndex;
+    if (layers[i] not_eq INPUT_LAYER)
+    {
+      auto pos = columns[i] - _layout.nInputs;
+      neuronHelper(&_layout.params[pos * MAX_NEURON_PARAMS],
+                   &_layout.types[pos],
+                   neuron);
+    }
+
+    // The ID maps are only needed to resolve later modifications
+    _layout.layerMap[neuron.id()] = neuron.layer();
+    _layout.positionMap[neuron.id()] = positions[i];
   }
 
   // Decode connections
-  this->nNonInputs_ = this->nOutputs_ + this->nHidden_;
-  auto connection = _settings->HasElement("rv:neural_connection")
-                    ? _settings->GetElement("rv:neural_connection")
-                    : sdf::ElementPtr();
-  while (connection)
+  std::vector< SparseMatrix::Triplet > connections;
+  connections.reserve(_network.connection_size());
+  for (const auto &connection : _network.connection())
   {
-    if (not connection->HasAttribute("src") or not connection
-        ->HasAttribute("dst") or not connection->HasAttribute("weight"))
+    auto src = indices.find(connection.src());
+    if (src == indices.end())
     {
-      std::cerr << "Missing required connection attributes (`src`, `dst` "
-          "or `weight`)." << std::endl;
+      std::cerr << "Source neuron '" << connection.src() << "' is unknown."
+                << std::endl;
       throw std::runtime_error("Robot brain error");
     }
 
-    auto src = connection->GetAttribute("src")->GetAsString();
-    auto dst = connection->GetAttribute("dst")->GetAsString();
-    double weight;
-    connection->GetAttribute("weight")->Get(weight);
+    auto dst = indices.find(connection.dst());
+    if (dst == indices.end())
+    {
+      std::cerr << "Destination neuron '" << connection.dst()
+                << "' is unknown." << std::endl;
+      throw std::runtime_error("Robot brain error");
+    }
 
-    // Use connection helper to set the weight
-    ConnectionHelper(src, dst, weight);
+    if (layers[dst->second] == INPUT_LAYER)
+    {
+      std::cerr << "Destination neuron '" << connection.dst()
+                << "' is an input neuron." << std::endl;
+      throw std::runtime_error("Robot brain error");
+    }
 
-    // Load the next connection
-    connection = connection->GetNextElement("rv:neural_connection");
+    connections.push_back({columns[dst->second] - _layout.nInputs,
+                           columns[src->second],
+                           connection.weight()});
   }
-}
 
-/////////////////////////////////////////////////
-NeuralNetwork::~NeuralNetwork() = default;
+  _layout.weights = SparseMatrix::FromTriplets(
+      _layout.nNonInputs,
+      _layout.nInputs + _layout.nNonInputs,
+      std::move(connections));
+}
 
 /////////////////////////////////////////////////
 void NeuralNetwork::Step(const double _time)
 {
-  unsigned int i = 0;
-  unsigned int j = 0;
+  const auto &layout = *this->layout_;
+  if (layout.nOutputs == 0)
+  {
+    return;
+  }
+
+  // Time covered by this step, for the neurons that integrate their state
+  const auto dt = _time > this->lastTime_ ? _time - this->lastTime_ : 0.0;
+  this->lastTime_ = _time;
 
-  if (this->nOutputs_ == 0)
+  auto activations = this->activations_.data();
+  if (layout.acyclic)
   {
+    // Every source of a batch is in an earlier batch, so the network is
+    // evaluated in place and a signal reaches the outputs in one step.
+    auto state = this->flipState_ ? this->state2_.data()
+                                  : this->state1_.data();
+    for (size_t b = 0; b < layout.batches.size(); ++b)
+    {
+      const auto &neurons = layout.batches[b].neurons;
+      if (layout.useCompact)
+      {
+        layout.compactWeights.MultiplyRows(
+            neurons.data(),
+            static_cast< unsigned int >(neurons.size()),
+            state,
+            this->compactInput_.data(),
+            activations);
+      }
+      else if (layout.useFixed)
+      {
+        layout.fixedWeights.MultiplyRows(
+            neurons.data(),
+            static_cast< unsigned int >(neurons.size()),
+            state,
+            activations);
+      }
+      else
+      {
+        for (const auto i : neurons)
+        {
+          activations[i] = layout.weights.RowDot(i, state);
+        }
+      }
+      this->Activate(b, activations, state + layout.nInputs, _time, dt);
+    }
     return;
   }
 
   double *curState, *nextState;
   if (this->flipState_)
   {
-    curState = this->state2_;
-    nextState = this->state1_;
+    curState = this->state2_.data();
+    nextState = this->state1_.data();
   }
   else
   {
-    curState = this->state1_;
-    nextState = this->state2_;
+    curState = this->state1_.data();
+    nextState = this->state2_.data();
   }
 
+  // Inputs are not computed, carry them over to the next state
+  std::copy(curState, curState + layout.nInputs, nextState);
 
-  unsigned int maxNonInputs = MAX_HIDDEN_NEURONS + MAX_OUTPUT_NEURONS;
-  for (i = 0; i < this->nNonInputs_; ++i)
+  // Weighted input sums of all non-input neurons at once
+  if (layout.useCompact)
   {
-    double curNeuronActivation = 0;
-
-    // Add input neuron values
-    for (j = 0; j < this->nInputs_; ++j)
-    {
-      curNeuronActivation += this->inputWeights_[maxNonInputs * j + i]
-                             * this->input_[j];
-    }
-
-    // Add output neuron values
-    for (j = 0; j < this->nOutputs_; ++j)
-    {
-      curNeuronActivation += this->outputWeights_[maxNonInputs * j + i]
-                             * curState[j];
-    }
+    layout.compactWeights.Multiply(
+        curState, this->compactInput_.data(), activations);
+  }
+  else if (layout.useFixed)
+  {
+    layout.fixedWeights.Multiply(curState, activations);
+  }
+  else if (layout.useDense)
+  {
+    layout.denseWeights.Multiply(
+        curState, this->denseInput_.data(), activations);
+  }
+  else
+  {
+    layout.weights.Multiply(curState, activations);
+  }
 
-    // Add hidden neuron values
-    for (j = 0; j < this->nHidden_; ++j)
-    {
-      curNeuronActivation += this->hiddenWeights_[maxNonInputs * j + i]
-                             * curState[this->nOutputs_ + j];
-    }
+  for (size_t b = 0; b < layout.batches.size(); ++b)
+  {
+    this->Activate(
+        b, activations, nextState + layout.nInputs, _time, dt);
+  }
 
-    unsigned int base = MAX_NEURON_PARAMS * i;
-    switch (this->types_[i])
-    {
-      case SIGMOID:
-        /* params are bias, gain */
-        curNeuronActivation -= this->params_[base];
-        nextState[i] =
-            1.0 / (1.0 + exp(-(this->params_[base + 1]) * curNeuronActivation));
-        break;
-      case SIMPLE:
-        /* linear, params are bias, gain */
-        curNeuronActivation -= this->params_[base];
-        nextState[i] = this->params_[base + 1] * curNeuronActivation;
-        break;
-      case OSCILLATOR:
-      { // Use the block to prevent "crosses initialization" error
-        /* params are period, phase offset, gain (amplitude) */
-        double period = this->params_[base];
-        double phaseOffset = this->params_[base + 1];
-        double gain = this->params_[base + 2];
+  this->flipState_ = not this->flipState_;
+}
 
+/////////////////////////////////////////////////
+void NeuralNetwork::Activate(
+    const size_t _batch,
+    const double *_sums,
+    double *_out,
+    const double _time,
+    const double _dt)
+{
+  const auto &batch = this->layout_->batches[_batch];
+  const auto n = batch.neurons.size();
+  const auto neurons = batch.neurons.data();
+  const auto p = batch.params.data();
+  auto x = this->scratch_.data();
+  switch (batch.type)
+  {
+    case SIGMOID:
+      /* params are bias, gain */
+      for (size_t k = 0; k < n; ++k)
+      {
+        x[k] = p[n + k] * (_sums[neurons[k]] - p[k]);
+      }
+      Activations::Sigmoid(x, x, n, this->accuracy_);
+      for (size_t k = 0; k < n; ++k)
+      {
+        _out[neurons[k]] = x[k];
+      }
+      break;
+    case SIMPLE:
+      /* linear, params are bias, gain */
+      for (size_t k = 0; k < n; ++k)
+      {
+        _out[neurons[k]] = p[n + k] * (_sums[neurons[k]] - p[k]);
+      }
+      break;
+    case OSCILLATOR:
+    { // Use the block to prevent "crosses initialization" error
+      /* params are period, phase offset, gain (amplitude) */
+      auto sine = this->oscillators_[_batch].Advance(_time);
+      for (size_t k = 0; k < n; ++k)
+      {
         /* Value in [0, 1] */
-        nextState[i] = ((sin((2.0 * M_PI / period) *
-                       (_time - period * phaseOffset))) + 1.0) / 2.0;
+        double value = (sine[k] + 1.0) / 2.0;
 
         /* set output to be in [0.5 - gain/2, 0.5 + gain/2] */
-        nextState[i] = (0.5 - (gain / 2.0) + nextState[i] * gain);
+        double gain = p[2 * n + k];
+        _out[neurons[k]] = 0.5 - (gain / 2.0) + value * gain;
       }
-        break;
-      default:
-        // Unsupported type should never happen
-        std::cerr << "Invalid neuron type during processing, must be a bug."
-                  << std::endl;
-        throw std::runtime_error("Robot brain error");
+      break;
     }
-  }
+    case CTRNN_SIGMOID:
+    {
+      /* params are bias, tau, gain */
+      // The state follows `tau * dy/dt = -y + input`, with the input held
+      // over the step like for every other neuron. Explicit Euler is
+      // accurate and free of overshoot for sub-steps up to `tau`, so the
+      // number of sub-steps is raised for stiff time constants, and the rate
+      // is capped at one, the limit of a vanishing time constant.
+      auto y = this->ctrnnStates_[_batch].data();
+      auto input = x + n;
+      if (_dt > 0)
+      {
+        auto minTau = *std::min_element(p + n, p + 2 * n);
+        auto steps = std::max(
+            static_cast< double >(this->substeps_),
+            std::min(std::ceil(_dt / minTau),
+                     static_cast< double >(MAX_SUBSTEPS)));
+        auto h = _dt / steps;
+        for (size_t k = 0; k < n; ++k)
+        {
+          input[k] = _sums[neurons[k]];
+          x[k] = std::min(h / p[n + k], 1.0);
+        }
+        for (unsigned int s = 0; s < steps; ++s)
+        {
+          for (size_t k = 0; k < n; ++k)
+          {
+            y[k] += x[k] * (input[k] - y[k]);
+          }
+        }
+      }
 
-  this->flipState_ = not this->flipState_;
+      for (size_t k = 0; k < n; ++k)
+      {
+        x[k] = p[2 * n + k] * (y[k] - p[k]);
+      }
+      Activations::Sigmoid(x, x, n, this->accuracy_);
+      for (size_t k = 0; k < n; ++k)
+      {
+        _out[neurons[k]] = x[k];
+      }
+      break;
+    }
+    case SUPG:
+      /* params are period, phase offset, gain */
+      // The unit adds its own timer, a ramp from -0.5 to 0.5 once per
+      // period, to its input, so without input it emits a periodic pattern
+      // shaped by the gain.
+      for (size_t k = 0; k < n; ++k)
+      {
+        auto phase = _time / p[k] - p[n + k];
+        auto timer = phase - std::floor(phase) - 0.5;
+        x[k] = p[2 * n + k] * (_sums[neurons[k]] + timer);
+      }
+      Activations::Sigmoid(x, x, n, this->accuracy_);
+      for (size_t k = 0; k < n; ++k)
+      {
+        _out[neurons[k]] = x[k];
+      }
+      break;
+    default:
+      // Unsupported type should never happen
+      std::cerr << "Invalid neuron type during processing, must be a bug."
+                << std::endl;
+      throw std::runtime_error("Robot brain error");
+  }
 }
 
 /////////////////////////////////////////////////
@@ -422,21 +607,38 @@ void NeuralNetwork::Update(
     const double _time,
     const double _step)
 {
-  boost::mutex::scoped_lock lock(this->networkMutex_);
+  // Switch to the layout of the latest modification. This only reads a
+  // flag and never waits for a modification in progress.
+  if (this->modified_.exchange(false))
+  {
+    this->Adopt(std::atomic_load(&this->published_));
+  }
 
   // Read sensor data and feed the neural network
+  auto input = this->flipState_ ? &this->state2_[0] : &this->state1_[0];
   unsigned int p = 0;
   for (const auto &sensor : _sensors)
   {
-    sensor->Read(&this->input_[p]);
+    sensor->Read(&input[p]);
     p += sensor->Inputs();
   }
 
+  // A pooled network is stepped and actuated at the end of the world update
+  if (this->pool_ and this->pool_->Submit(this, input, _motors, _time, _step))
+  {
+    return;
+  }
+
   this->Step(_time);
 
-  // Since the output neurons are the first in the state
+  // Since the output neurons directly follow the inputs in the state
   // array we can just use it to update the motors directly.
   auto output = this->flipState_ ? &this->state2_[0] : &this->state1_[0];
+  if (this->recorder_)
+  {
+    this->recorder_->Record(_time, output);
+  }
+  output += this->layout_->nInputs;
 
   // Send new signals to the motors
   p = 0;
@@ -450,20 +652,44 @@ void NeuralNetwork::Update(
 /////////////////////////////////////////////////
 void NeuralNetwork::Modify(ConstModifyNeuralNetworkPtr &_request)
 {
+  // Serializes modifications only, `Update()` does not take this lock
   boost::mutex::scoped_lock lock(this->networkMutex_);
 
-  unsigned int i, j;
+  // Edit a copy of the latest layout, the published one may be in use
+  auto layout = std::make_shared< Layout >(
+      *std::atomic_load(&this->published_));
+
+  // The connections are collected by neuron key and the weights are
+  // rebuilt once at the end, rather than moving the matrix around for every
+  // single edit.
+  std::vector< SparseMatrix::Triplet > connections;
+  connections.reserve(
+      layout->weights.NonZeros() + _request->set_weights_size());
+  const auto &offsets = layout->weights.Offsets();
+  const auto &columns = layout->weights.Columns();
+  const auto &values = layout->weights.Values();
+  for (unsigned int row = 0; row < layout->nNonInputs; ++row)
+  {
+    for (auto k = offsets[row]; k < offsets[row + 1]; ++k)
+    {
+      connections.push_back({layout->keys[layout->nInputs + row],
+                             layout->keys[columns[k]],
+                             values[k]});
+    }
+  }
+
+  unsigned int i;
   for (i = 0; i < (unsigned int)_request->remove_hidden_size(); ++i)
   {
     // Find the neuron + position
     auto id = _request->remove_hidden(i);
-    if (not this->positionMap_.count(id))
+    if (not layout->positionMap.count(id))
     {
       std::cerr << "Unknown neuron ID `" << id << "`" << std::endl;
       throw std::runtime_error("Robot brain error");
     }
 
-    if ("hidden" not_eq this->layerMap_[id])
+    if ("hidden" not_eq layout->layerMap[id])
     {
       std::cerr
           << "Cannot remove neuron ID `"
@@ -473,139 +699,63 @@ void NeuralNetwork::Modify(ConstModifyNeuralNetworkPtr &_request)
       throw std::runtime_error("Robot brain error");
     }
 
-    auto pos = this->positionMap_[id];
-    this->positionMap_.erase(id);
-    this->layerMap_.erase(id);
-
-    // Shift types
-    auto s = sizeof(this->types_[0]);
-    std::memmove(
-        // Position shifted one type to the left
-        this->types_ + (pos + this->nOutputs_) * s,
-
-        // Position of next neuron type
-        this->types_ + (pos + this->nOutputs_ + 1) * s,
-
-        // # of hidden neurons beyond this one
-        s * (this->nHidden_ - pos - 1));
-
-    // Shift parameters
-    s = sizeof(this->params_[0]);
-    std::memmove(
-        // Position of item to remove
-        this->params_ + (pos + this->nOutputs_) * MAX_NEURON_PARAMS * s,
-
-        // Position of next neuron type
-        this->params_ + (pos + this->nOutputs_ + 1) * MAX_NEURON_PARAMS * s,
-
-        // # of hidden neurons beyond this one
-        (this->nHidden_ - pos - 1) * MAX_NEURON_PARAMS * s);
-
-    // Reposition items in weight arrays. We start with the weights of
-    // connections pointing *to* the neuron to be removed. For each entry in
-    // each of the three weights arrays we have to move all hidden connection
-    // weights down, then zero out the last entry
-    s = sizeof(this->inputWeights_[0]);
-    double *weightArrays[] = {
-        this->inputWeights_,
-        this->outputWeights_,
-        this->hiddenWeights_
-    };
-    unsigned int sizes[] = {
-        this->nInputs_,
-        this->nOutputs_,
-        this->nHidden_
-    };
-
-    for (size_t k = 0; k < 3; ++k)
-    {
-      auto weights = weightArrays[k];
-      auto size = sizes[k];
-
-      for (j = 0; j < size; ++j)
-      {
-        std::memmove(
-            // Position of item to remove
-            weights + (this->nOutputs_ + pos) * s,
-
-            // Position of next item
-            weights + (this->nOutputs_ + pos + 1) * s,
-
-            // # of possible hidden neurons beyond this one
-            (MAX_HIDDEN_NEURONS - pos - 1) * s);
-
-        // Zero out the last item in case a connection that corresponds to it
-        // is ever added.
-        weights[this->nOutputs_ + pos] = 0;
-      }
-    }
-
-    // Now the weights where the removed neuron is the source. The block of
-    // weights corresponding to the neuron that is being removed needs to be
-    // removed by shifting down all items beyond it.
-    std::memmove(
-        // Position of the item to remove
-        this->hiddenWeights_ + pos * MAX_NON_INPUT_NEURONS * s,
+    auto pos = layout->positionMap[id];
+    layout->positionMap.erase(id);
+    layout->layerMap.erase(id);
 
-        // Position of the next item
-        this->hiddenWeights_ + (pos + 1) * MAX_NON_INPUT_NEURONS * s,
-
-        // Remaining number of memory items
-        (MAX_HIDDEN_NEURONS - pos - 1) * MAX_NON_INPUT_NEURONS * s);
-
-    // Zero the remaining entries at the end
-    std::memset(this->hiddenWeights_ + (MAX_HIDDEN_NEURONS - 1) * s,
-           0,
-           MAX_NON_INPUT_NEURONS * s);
+    // Drop the neuron's type, params and key. Its connections are dropped
+    // with the key when the weights are rebuilt.
+    auto row = layout->nOutputs + pos;
+    layout->types.erase(layout->types.begin() + row);
+    layout->params.erase(
+        layout->params.begin() + row * MAX_NEURON_PARAMS,
+        layout->params.begin() + (row + 1) * MAX_NEURON_PARAMS);
+    layout->keys.erase(layout->keys.begin() + layout->nInputs + row);
 
     // Decrement the entry in the `positionMap` for all hidden neurons above
     // this one.
-    for (auto iter = this->positionMap_.begin();
-         iter not_eq this->positionMap_.end(); ++iter)
+    for (auto iter = layout->positionMap.begin();
+         iter not_eq layout->positionMap.end(); ++iter)
     {
-      auto layer = this->layerMap_[iter->first];
-      if ("hidden" == layer and this->positionMap_[iter->first] > pos)
+      auto layer = layout->layerMap[iter->first];
+      if ("hidden" == layer and layout->positionMap[iter->first] > pos)
       {
-        --(this->positionMap_[iter->first]);
+        --(layout->positionMap[iter->first]);
       }
     }
 
-    --(this->nHidden_);
-    --(this->nNonInputs_);
+    --(layout->nHidden);
+    --(layout->nNonInputs);
   }
 
   // Add new requested hidden neurons
   for (i = 0; i < (unsigned int)_request->add_hidden_size(); ++i)
   {
-    if (this->nHidden_ >= MAX_HIDDEN_NEURONS)
-    {
-      std::cerr
-          << "Cannot add hidden neuron; the max ("
-          << MAX_HIDDEN_NEURONS
-          << ") is already reached."
-          << std::endl;
-      throw std::runtime_error("Robot brain error");
-    }
-
     auto neuron = _request->add_hidden(i);
     const auto id = neuron.id();
-    if (this->layerMap_.count(id))
+    if (layout->layerMap.count(id))
     {
       std::cerr << "Adding duplicate neuron ID `" << id << "`" << std::endl;
       throw std::runtime_error("Robot brain error");
     }
 
-    this->positionMap_[id] = this->nHidden_;
-    this->layerMap_[id] = "hidden";
+    layout->positionMap[id] = layout->nHidden;
+    layout->layerMap[id] = "hidden";
+
+    // Hidden neurons are last in both the rows and the columns of the
+    // weights, so a new one is simply appended.
+    unsigned int pos = layout->nOutputs + layout->nHidden;
+    layout->types.push_back(0);
+    layout->params.resize(layout->params.size() + MAX_NEURON_PARAMS, 0);
+    layout->keys.push_back(layout->nextKey++);
 
-    unsigned int pos = this->nOutputs_ + this->nHidden_;
     neuronHelper(
-        &this->params_[pos * MAX_NEURON_PARAMS],
-        &this->types_[pos],
+        &layout->params[pos * MAX_NEURON_PARAMS],
+        &layout->types[pos],
         neuron);
 
-    ++(this->nHidden_);
-    ++(this->nNonInputs_);
+    ++(layout->nHidden);
+    ++(layout->nNonInputs);
   }
 
   // Update parameters of existing neurons
@@ -613,14 +763,18 @@ void NeuralNetwork::Modify(ConstModifyNeuralNetworkPtr &_request)
   {
     auto neuron = _request->set_parameters(i);
     const auto id = neuron.id();
-    if (not this->positionMap_.count(id))
+    if (not layout->positionMap.count(id))
     {
       std::cerr << "Unknown neuron ID `" << id << "`" << std::endl;
       throw std::runtime_error("Robot brain error");
     }
 
-    auto pos = this->positionMap_[id];
-    auto layer = this->layerMap_[id];
+    auto pos = layout->positionMap[id];
+    auto layer = layout->layerMap[id];
+    if ("hidden" == layer)
+    {
+      pos += layout->nOutputs;
+    }
 
     if ("input" == layer)
     {
@@ -629,44 +783,316 @@ void NeuralNetwork::Modify(ConstModifyNeuralNetworkPtr &_request)
     }
 
     neuronHelper(
-        &this->params_[pos * MAX_NEURON_PARAMS],
-        &this->types_[pos],
+        &layout->params[pos * MAX_NEURON_PARAMS],
+        &layout->types[pos],
         neuron);
   }
 
-  // Set weights of new or existing connections
+  // Set weights of new or existing connections, a later entry for the same
+  // connection overrides the earlier ones
   for (i = 0; i < (unsigned int)_request->set_weights_size(); ++i)
   {
     auto conn = _request->set_weights(i);
     const auto src = conn.src();
     const auto dst = conn.dst();
-    this->ConnectionHelper(src, dst, conn.weight());
+    auto entry = NeuralNetwork::ConnectionHelper(
+        *layout, src, dst, conn.weight());
+    connections.push_back({layout->keys[layout->nInputs + entry.row],
+                           layout->keys[entry.column],
+                           entry.value});
+  }
+
+  // Translate the keys back to rows and columns. Keys are ascending, so a
+  // binary search finds the column of a key, and removed neurons are gone.
+  const auto &keys = layout->keys;
+  auto columnOf = [&keys](const unsigned int _key, unsigned int &_column)
+  {
+    auto iter = std::lower_bound(keys.begin(), keys.end(), _key);
+    _column = static_cast< unsigned int >(iter - keys.begin());
+    return iter not_eq keys.end() and *iter == _key;
+  };
+
+  size_t kept = 0;
+  for (const auto &connection : connections)
+  {
+    unsigned int row, column;
+    if (columnOf(connection.row, row) and
+        columnOf(connection.column, column))
+    {
+      connections[kept++] = {row - layout->nInputs, column, connection.value};
+    }
+  }
+  connections.resize(kept);
+
+  layout->weights = SparseMatrix::FromTriplets(
+      layout->nNonInputs,
+      layout->nInputs + layout->nNonInputs,
+      std::move(connections));
+  NeuralNetwork::Compile(*layout);
+
+  // Publish the new layout with a single pointer swap
+  std::atomic_store(&this->published_, ConstLayoutPtr(std::move(layout)));
+  this->modified_ = true;
+}
+
+/////////////////////////////////////////////////
+void NeuralNetwork::Adopt(const ConstLayoutPtr &_layout)
+{
+  if (_layout == this->layout_)
+  {
+    return;
+  }
+
+  // The pool holds the latest state of a pooled network
+  if (this->pool_)
+  {
+    this->pool_->Fetch(this);
+  }
+
+  // Carry the state of every neuron that still exists over to its new
+  // column. Keys ascend in both layouts, so this is a single merge.
+  std::vector< double > state(_layout->keys.size(), 0);
+  const auto unassigned = std::numeric_limits< size_t >::max();
+  std::vector< size_t > previous(_layout->keys.size(), unassigned);
+  if (this->layout_)
+  {
+    const auto &current = this->flipState_ ? this->state2_ : this->state1_;
+    const auto &keys = this->layout_->keys;
+    size_t j = 0;
+    for (size_t i = 0; i < state.size(); ++i)
+    {
+      while (j < keys.size() and keys[j] < _layout->keys[i])
+      {
+        ++j;
+      }
+      if (j < keys.size() and keys[j] == _layout->keys[i])
+      {
+        state[i] = current[j];
+        previous[i] = j;
+      }
+    }
+  }
+
+  // The integrated CTRNN state is kept per batch, so spread it over the
+  // columns of the current layout before the batches are replaced.
+  std::vector< double > integrated;
+  if (this->layout_)
+  {
+    integrated.assign(this->layout_->keys.size(), 0);
+    for (size_t b = 0; b < this->layout_->batches.size(); ++b)
+    {
+      const auto &batch = this->layout_->batches[b];
+      if (batch.type == CTRNN_SIGMOID)
+      {
+        for (size_t k = 0; k < batch.neurons.size(); ++k)
+        {
+          integrated[this->layout_->nInputs + batch.neurons[k]] =
+              this->ctrnnStates_[b][k];
+        }
+      }
+    }
+  }
+
+  // Both buffers start out equal, so an acyclic network can continue in
+  // place on either of them.
+  this->state1_ = state;
+  this->state2_ = std::move(state);
+  this->flipState_ = false;
+
+  this->activations_.assign(_layout->nNonInputs, 0);
+  this->scratch_.assign(2 * _layout->largestBatch, 0);
+  this->denseInput_.assign(_layout->denseWeights.Stride(), 0);
+  this->compactInput_.assign(_layout->compactWeights.Stride(), 0);
+  this->oscillators_.assign(_layout->batches.size(), OscillatorBank());
+  this->ctrnnStates_.assign(_layout->batches.size(), std::vector< double >());
+  for (size_t b = 0; b < _layout->batches.size(); ++b)
+  {
+    const auto &batch = _layout->batches[b];
+    if (batch.type == OSCILLATOR)
+    {
+      const auto n = batch.neurons.size();
+      this->oscillators_[b].Reset(
+          batch.params.data(), batch.params.data() + n, n, this->accuracy_);
+    }
+    else if (batch.type == CTRNN_SIGMOID)
+    {
+      // Only new neurons start from rest
+      auto &ctrnn = this->ctrnnStates_[b];
+      ctrnn.assign(batch.neurons.size(), 0);
+      for (size_t k = 0; k < batch.neurons.size(); ++k)
+      {
+        const auto j = previous[_layout->nInputs + batch.neurons[k]];
+        if (j not_eq unassigned)
+        {
+          ctrnn[k] = integrated[j];
+        }
+      }
+    }
+  }
+
+  this->layout_ = _layout;
+
+  // Name the trace columns after the neurons in state order
+  if (this->recorder_)
+  {
+    std::vector< std::string > names(_layout->keys.size());
+    for (const auto &position : _layout->positionMap)
+    {
+      auto layer = _layout->layerMap.at(position.first);
+      auto offset = "input" == layer ? 0
+                    : "output" == layer ? _layout->nInputs
+                    : _layout->nInputs + _layout->nOutputs;
+      names[offset + position.second] = position.first;
+    }
+    this->recorder_->SetColumns(names);
+  }
+
+  // Rewrites the lane in place, or moves the network to its new group
+  if (this->pool_)
+  {
+    this->pool_->Add(this);
   }
 }
 
 /////////////////////////////////////////////////
-void NeuralNetwork::ConnectionHelper(
+void NeuralNetwork::Compile(Layout &_layout)
+{
+  // Try to sort the non-input neurons topologically (Kahn's algorithm).
+  // Inputs never depend on anything, so only connections between
+  // non-input neurons are considered. If a cycle remains, the network
+  // keeps the synchronous, double buffered evaluation.
+  const auto &offsets = _layout.weights.Offsets();
+  const auto &columns = _layout.weights.Columns();
+
+  std::vector< unsigned int > inDegree(_layout.nNonInputs, 0);
+  std::vector< std::vector< unsigned int > > successors(_layout.nNonInputs);
+  for (unsigned int i = 0; i < _layout.nNonInputs; ++i)
+  {
+    for (auto k = offsets[i]; k < offsets[i + 1]; ++k)
+    {
+      if (columns[k] >= _layout.nInputs)
+      {
+        successors[columns[k] - _layout.nInputs].push_back(i);
+        ++inDegree[i];
+      }
+    }
+  }
+
+  // The level of a neuron is the length of the longest path reaching it
+  // from a neuron without non-input sources.
+  std::vector< unsigned int > levels(_layout.nNonInputs, 0);
+  _layout.order.clear();
+  for (unsigned int i = 0; i < _layout.nNonInputs; ++i)
+  {
+    if (inDegree[i] == 0)
+    {
+      _layout.order.push_back(i);
+    }
+  }
+  for (size_t k = 0; k < _layout.order.size(); ++k)
+  {
+    const auto i = _layout.order[k];
+    for (const auto successor : successors[i])
+    {
+      levels[successor] = std::max(levels[successor], levels[i] + 1);
+      if (--inDegree[successor] == 0)
+      {
+        _layout.order.push_back(successor);
+      }
+    }
+  }
+
+  _layout.acyclic = _layout.order.size() == _layout.nNonInputs;
+  if (not _layout.acyclic)
+  {
+    _layout.order.clear();
+    levels.assign(_layout.nNonInputs, 0);
+  }
+
+  // Batch the neurons by level, then type. A cyclic network is a single
+  // level, since all its neurons are computed from the previous state.
+  std::map< std::pair< unsigned int, unsigned int >, NeuronBatch > batches;
+  for (unsigned int i = 0; i < _layout.nNonInputs; ++i)
+  {
+    auto &batch = batches[std::make_pair(levels[i], _layout.types[i])];
+    batch.type = _layout.types[i];
+    batch.neurons.push_back(i);
+  }
+
+  _layout.batches.clear();
+  _layout.largestBatch = 0;
+  for (auto &entry : batches)
+  {
+    auto &batch = entry.second;
+    const auto n = batch.neurons.size();
+    batch.params.resize(MAX_NEURON_PARAMS * n);
+    for (size_t k = 0; k < n; ++k)
+    {
+      for (unsigned int j = 0; j < MAX_NEURON_PARAMS; ++j)
+      {
+        batch.params[j * n + k] =
+            _layout.params[MAX_NEURON_PARAMS * batch.neurons[k] + j];
+      }
+    }
+    _layout.largestBatch = std::max(_layout.largestBatch, n);
+    _layout.batches.push_back(std::move(batch));
+  }
+
+  // A reduced precision replaces every double representation, the smaller
+  // weights are the point of it whatever the size or density.
+  _layout.useCompact = _layout.precision not_eq DOUBLE_WEIGHTS;
+  _layout.compactWeights = _layout.useCompact
+                           ? CompactMatrix(_layout.weights, _layout.precision)
+                           : CompactMatrix();
+
+  // Tiny networks use the kernels unrolled for their exact size, whatever
+  // their density or evaluation order.
+  _layout.useFixed = not _layout.useCompact and
+                     _layout.weights.Cols() > 0 and
+                     _layout.weights.Cols() <= FixedMatrix::MAX_COLUMNS;
+  _layout.fixedWeights = _layout.useFixed
+                         ? FixedMatrix(_layout.weights)
+                         : FixedMatrix();
+
+  // Dense rows let the SIMD kernels stream contiguous weights, which is
+  // faster than the indirect loads of the sparse rows unless most of the
+  // weights are zero. Acyclic networks are evaluated row by row and always
+  // use the sparse rows.
+  auto size = static_cast< double >(_layout.weights.Rows()) *
+              _layout.weights.Cols();
+  _layout.useDense = not _layout.useCompact and not _layout.useFixed and
+                     not _layout.acyclic and
+                     _layout.weights.NonZeros() >
+                     DENSE_WEIGHTS_THRESHOLD * size;
+  _layout.denseWeights = _layout.useDense
+                         ? DenseMatrix(_layout.weights)
+                         : DenseMatrix();
+}
+
+/////////////////////////////////////////////////
+SparseMatrix::Triplet NeuralNetwork::ConnectionHelper(
+    Layout &_layout,
     const std::string &_src,
     const std::string &_dst,
     const double _weight)
 {
-  if (not this->layerMap_.count(_src))
+  if (not _layout.layerMap.count(_src))
   {
     std::cerr << "Source neuron '" << _src << "' is unknown." << std::endl;
     throw std::runtime_error("Robot brain error");
   }
 
-  if (not this->layerMap_.count(_dst))
+  if (not _layout.layerMap.count(_dst))
   {
     std::cerr << "Destination neuron '" << _dst << "' is unknown." << std::endl;
     throw std::runtime_error("Robot brain error");
   }
 
-  auto srcLayer = this->layerMap_[_src];
-  auto dstLayer = this->layerMap_[_dst];
+  auto srcLayer = _layout.layerMap[_src];
+  auto dstLayer = _layout.layerMap[_dst];
 
-  unsigned int srcNeuronPos = this->positionMap_[_src],
-      dstNeuronPos = this->positionMap_[_dst];
+  unsigned int srcNeuronPos = _layout.positionMap[_src],
+      dstNeuronPos = _layout.positionMap[_dst];
 
   if ("input" == dstLayer)
   {
@@ -680,73 +1106,82 @@ void NeuralNetwork::ConnectionHelper(
   else if ("hidden" == dstLayer)
   {
     // Offset with output neurons for hidden neuron position
-    dstNeuronPos += this->nOutputs_;
+    dstNeuronPos += _layout.nOutputs;
   }
 
-  // Determine the index of the weight.
-  unsigned int idx = (srcNeuronPos * MAX_NON_INPUT_NEURONS) + dstNeuronPos;
-  if ("input" == srcLayer)
-  {
-    this->inputWeights_[idx] = _weight;
-  }
-  else if ("output" == srcLayer)
+  // Determine the column of the source within the state vector, which holds
+  // inputs first, then outputs, then hidden neurons.
+  if ("output" == srcLayer)
   {
-    this->outputWeights_[idx] = _weight;
+    srcNeuronPos += _layout.nInputs;
   }
-  else
+  else if ("hidden" == srcLayer)
   {
-    this->hiddenWeights_[idx] = _weight;
+    srcNeuronPos += _layout.nInputs + _layout.nOutputs;
   }
+
+  return {dstNeuronPos, srcNeuronPos, _weight};
 }
 
 /////////////////////////////////////////////////
 void neuronHelper(
     double *params,
     unsigned int *types,
-    sdf::ElementPtr neuron)
+    const revolve::msgs::Neuron &neuron)
 {
-  if (not neuron->HasAttribute("type"))
-  {
-    std::cerr << "Missing required `type` attribute for neuron." << std::endl;
-    throw std::runtime_error("Robot brain error");
-  }
-
-  const auto type = neuron->GetAttribute("type")->GetAsString();
+  const auto type = neuron.type();
   if ("Sigmoid" == type or "Simple" == type)
   {
-    types[0] = ("Simple" == type ? SIMPLE : SIGMOID);
-
-    if (not neuron->HasElement("rv:bias") or not neuron->HasElement("rv:gain"))
+    types[0] = "Simple" == type ? SIMPLE : SIGMOID;
+    if (neuron.param_size() not_eq 2)
     {
-      std::cerr
-          << "A `"
-          << type
-          << "` neuron requires `rv:bias` and `rv:gain` elements."
-          << std::endl;
+      std::cerr << "A `" << type
+                << "` neuron requires exactly two parameters." << std::endl;
       throw std::runtime_error("Robot brain error");
     }
 
     // Set bias and gain parameters
-    params[0] = neuron->GetElement("rv:bias")->Get< double >();
-    params[1] = neuron->GetElement("rv:gain")->Get< double >();
+    params[0] = neuron.param(0).value();
+    params[1] = neuron.param(1).value();
   }
   else if ("Oscillator" == type)
   {
     types[0] = OSCILLATOR;
 
-    if (not neuron->HasElement("rv:period") or not neuron
-        ->HasElement("rv:phase_offset") or not neuron
-        ->HasElement("rv:amplitude"))
+    if (neuron.param_size() not_eq 3)
+    {
+      std::cerr << "A `" << type
+                << "` neuron requires exactly three parameters." << std::endl;
+      throw std::runtime_error("Robot brain error");
+    }
+
+    params[0] = neuron.param(0).value();
+    params[1] = neuron.param(1).value();
+    params[2] = neuron.param(2).value();
+  }
+  else if ("CTRNN_Sigmoid" == type or "SUPG" == type)
+  {
+    types[0] = "SUPG" == type ? SUPG : CTRNN_SIGMOID;
+
+    if (neuron.param_size() not_eq 3)
     {
-      std::cerr << "An `Oscillator` neuron requires `rv:period`, "
-          "`rv:phase_offset` and `rv:amplitude` elements." << std::endl;
+      std::cerr << "A `" << type
+                << "` neuron requires exactly three parameters." << std::endl;
       throw std::runtime_error("Robot brain error");
     }
 
-    // Set period, phase offset and gain
-    params[0] = neuron->GetElement("rv:period")->Get< double >();
-    params[1] = neuron->GetElement("rv:phase_offset")->Get< double >();
-    params[2] = neuron->GetElement("rv:amplitude")->Get< double >();
+    // Set bias, time constant and gain, or period, phase offset and gain.
+    // The time constant and the period are both divisors.
+    params[0] = neuron.param(0).value();
+    params[1] = neuron.param(1).value();
+    params[2] = neuron.param(2).value();
+    if (not (params[types[0] == SUPG ? 0 : 1] > 0))
+    {
+      std::cerr << "A `" << type << "` neuron requires a positive "
+                << (types[0] == SUPG ? "period." : "time constant.")
+                << std::endl;
+      throw std::runtime_error("Robot brain error");
+    }
   }
   else
   {
@@ -756,44 +1191,231 @@ void neuronHelper(
 }
 
 /////////////////////////////////////////////////
-void neuronHelper(
-    double *params,
-    unsigned int *types,
-    const revolve::msgs::Neuron &neuron)
+revolve::msgs::NeuralNetwork networkFromSdf(const sdf::ElementPtr &_settings)
 {
-  const auto type = neuron.type();
-  if ("Sigmoid" == type or "Simple" == type)
+  revolve::msgs::NeuralNetwork network;
+
+  // Fetch the first neuron; note the HasElement call is necessary to
+  // prevent SDF from complaining if no neurons are present.
+  auto controller = _settings->GetElement("rv:controller");
+  auto neuron = controller->HasElement("rv:neuron")
+                ? controller->GetElement("rv:neuron")
+                : sdf::ElementPtr();
+  while (neuron)
   {
-    types[0] = "Simple" == type ? SIMPLE : SIGMOID;
-    if (neuron.param_size() not_eq 2)
+    if (not neuron->HasAttribute("layer") or not neuron->HasAttribute("id"))
     {
-      std::cerr << "A `" << type
-                << "` neuron requires exactly two parameters." << std::endl;
+      std::cerr << "Missing required neuron attributes (id or layer). '"
+                << std::endl;
       throw std::runtime_error("Robot brain error");
     }
 
-    // Set bias and gain parameters
-    params[0] = neuron.param(0).value();
-    params[1] = neuron.param(1).value();
+    auto message = network.add_neuron();
+    message->set_id(neuron->GetAttribute("id")->GetAsString());
+    message->set_layer(neuron->GetAttribute("layer")->GetAsString());
+    if (neuron->HasAttribute("part_id"))
+    {
+      message->set_partid(neuron->GetAttribute("part_id")->GetAsString());
+    }
+
+    // Input neurons can currently not have a type
+    if ("input" == message->layer())
+    {
+      message->set_type(neuron->HasAttribute("type")
+                        ? neuron->GetAttribute("type")->GetAsString()
+                        : "Input");
+      neuron = neuron->GetNextElement("rv:neuron");
+      continue;
+    }
+
+    if (not neuron->HasAttribute("type"))
+    {
+      std::cerr << "Missing required `type` attribute for neuron." << std::endl;
+      throw std::runtime_error("Robot brain error");
+    }
+
+    // The params are listed in the order `neuronHelper()` expects them
+    const auto type = neuron->GetAttribute("type")->GetAsString();
+    message->set_type(type);
+    std::vector< std::string > params;
+    if ("Sigmoid" == type or "Simple" == type)
+    {
+      if (not neuron->HasElement("rv:bias") or
+          not neuron->HasElement("rv:gain"))
+      {
+        std::cerr
+            << "A `"
+            << type
+            << "` neuron requires `rv:bias` and `rv:gain` elements."
+            << std::endl;
+        throw std::runtime_error("Robot brain error");
+      }
+      params = {"rv:bias", "rv:gain"};
+    }
+    else if ("Oscillator" == type)
+    {
+      if (not neuron->HasElement("rv:period") or not neuron
+          ->HasElement("rv:phase_offset") or not neuron
+          ->HasElement("rv:amplitude"))
+      {
+        std::cerr << "An `Oscillator` neuron requires `rv:period`, "
+            "`rv:phase_offset` and `rv:amplitude` elements." << std::endl;
+        throw std::runtime_error("Robot brain error");
+      }
+      params = {"rv:period", "rv:phase_offset", "rv:amplitude"};
+    }
+    else if ("CTRNN_Sigmoid" == type or "SUPG" == type)
+    {
+      params = "SUPG" == type
+               ? std::vector< std::string >{
+                   "rv:period", "rv:phase_offset", "rv:gain"}
+               : std::vector< std::string >{"rv:bias", "rv:tau", "rv:gain"};
+      for (const auto &param : params)
+      {
+        if (not neuron->HasElement(param))
+        {
+          std::cerr << "A `" << type << "` neuron requires a `" << param
+                    << "` element." << std::endl;
+          throw std::runtime_error("Robot brain error");
+        }
+      }
+    }
+
+    for (const auto &param : params)
+    {
+      message->add_param()->set_value(
+          neuron->GetElement(param)->Get< double >());
+    }
+
+    neuron = neuron->GetNextElement("rv:neuron");
   }
-  else if ("Oscillator" == type)
-  {
-    types[0] = OSCILLATOR;
 
-    if (neuron.param_size() not_eq 3)
+  // Decode connections
+  auto connection = _settings->HasElement("rv:neural_connection")
+                    ? _settings->GetElement("rv:neural_connection")
+                    : sdf::ElementPtr();
+  while (connection)
+  {
+    if (not connection->HasAttribute("src") or not connection
+        ->HasAttribute("dst") or not connection->HasAttribute("weight"))
     {
-      std::cerr << "A `" << type
-                << "` neuron requires exactly three parameters." << std::endl;
+      std::cerr << "Missing required connection attributes (`src`, `dst` "
+          "or `weight`)." << std::endl;
       throw std::runtime_error("Robot brain error");
     }
 
-    params[0] = neuron.param(0).value();
-    params[1] = neuron.param(1).value();
-    params[2] = neuron.param(2).value();
+    auto message = network.add_connection();
+    message->set_src(connection->GetAttribute("src")->GetAsString());
+    message->set_dst(connection->GetAttribute("dst")->GetAsString());
+    double weight;
+    connection->GetAttribute("weight")->Get(weight);
+    message->set_weight(weight);
+
+    // Load the next connection
+    connection = connection->GetNextElement("rv:neural_connection");
+  }
+
+  return network;
+}
+
+/////////////////////////////////////////////////
+revolve::msgs::NeuralNetwork networkFromPayload(
+    const sdf::ElementPtr &_payload)
+{
+  // SDF is text, so the message is either embedded as base64 or read from
+  // a binary file the element points to.
+  auto encoding = _payload->HasAttribute("encoding")
+                  ? _payload->GetAttribute("encoding")->GetAsString()
+                  : "base64";
+  auto text = _payload->Get< std::string >();
+
+  std::string bytes;
+  if ("base64" == encoding)
+  {
+    bytes = decodeBase64(text);
+  }
+  else if ("file" == encoding)
+  {
+    std::ifstream file(text, std::ios::binary);
+    if (not file)
+    {
+      std::cerr << "Cannot open neural network file `" << text << "`."
+                << std::endl;
+      throw std::runtime_error("Robot brain error");
+    }
+    bytes.assign(std::istreambuf_iterator< char >(file),
+                 std::istreambuf_iterator< char >());
   }
   else
   {
-    std::cerr << "Unsupported neuron type `" << type << '`' << std::endl;
+    std::cerr << "Unknown neural network encoding `" << encoding
+              << "`, expected `base64` or `file`." << std::endl;
     throw std::runtime_error("Robot brain error");
   }
+
+  revolve::msgs::NeuralNetwork network;
+  if (not network.ParseFromString(bytes))
+  {
+    std::cerr << "Invalid `revolve.msgs.NeuralNetwork` message in "
+        "`rv:network`." << std::endl;
+    throw std::runtime_error("Robot brain error");
+  }
+  return network;
+}
+
+/////////////////////////////////////////////////
+std::string decodeBase64(const std::string &_text)
+{
+  std::string bytes;
+  bytes.reserve(_text.size() * 3 / 4);
+
+  unsigned int buffer = 0;
+  int bits = 0;
+  for (const auto c : _text)
+  {
+    int value;
+    if (c >= 'A' and c <= 'Z')
+    {
+      value = c - 'A';
+    }
+    else if (c >= 'a' and c <= 'z')
+    {
+      value = c - 'a' + 26;
+    }
+    else if (c >= '0' and c <= '9')
+    {
+      value = c - '0' + 52;
+    }
+    else if (c == '+')
+    {
+      value = 62;
+    }
+    else if (c == '/')
+    {
+      value = 63;
+    }
+    else if (c == '=')
+    {
+      break;
+    }
+    else if (std::isspace(static_cast< unsigned char >(c)))
+    {
+      continue;
+    }
+    else
+    {
+      std::cerr << "Invalid character in base64 neural network."
+                << std::endl;
+      throw std::runtime_error("Robot brain error");
+    }
+
+    buffer = (buffer << 6) | static_cast< unsigned int >(value);
+    bits += 6;
+    if (bits >= 8)
+    {
+      bits -= 8;
+      bytes.push_back(static_cast< char >((buffer >> bits) & 0xFF));
+    }
+  }
+  return bytes;
 }
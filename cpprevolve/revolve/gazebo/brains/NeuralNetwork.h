@@ -22,7 +22,9 @@
 #ifndef REVOLVE_GAZEBO_BRAIN_NEURALNETWORK_H_
 #define REVOLVE_GAZEBO_BRAIN_NEURALNETWORK_H_
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -30,23 +32,29 @@
 
 #include <revolve/msgs/neural_net.pb.h>
 
+#include "Activations.h"
 #include "Brain.h"
+#include "BrainPool.h"
+#include "CompactMatrix.h"
+#include "DenseMatrix.h"
+#include "FixedMatrix.h"
+#include "OscillatorBank.h"
+#include "SparseMatrix.h"
+#include "TraceRecorder.h"
 
-/// These numbers are quite arbitrary. It used to be in:13 out:8 for the
-/// Arduino, but I upped them both to 20 to accommodate other scenarios.
-/// Should really be enforced in the Python code, this implementation should
-/// not be the limit.
-#define MAX_INPUT_NEURONS 20
-#define MAX_OUTPUT_NEURONS 20
+/// (bias, tau, gain) or (phase offset, period, gain)
+#define MAX_NEURON_PARAMS 3
 
-/// Arbitrary value
-#define MAX_HIDDEN_NEURONS 30
+/// Fraction of non-zero weights above which the dense SIMD kernels beat
+/// walking the sparse rows.
+#define DENSE_WEIGHTS_THRESHOLD 0.25
 
-/// Convenience
-#define MAX_NON_INPUT_NEURONS (MAX_HIDDEN_NEURONS + MAX_OUTPUT_NEURONS)
+/// Upper bound of the integration sub-steps per step that are added for
+/// stiff time constants
+#define MAX_SUBSTEPS 64
 
-/// (bias, tau, gain) or (phase offset, period, gain)
-#define MAX_NEURON_PARAMS 3
+/// Rows of the trace ring buffer unless `trace_capacity` is given
+#define DEFAULT_TRACE_CAPACITY 4096
 
 namespace revolve
 {
@@ -69,6 +77,9 @@ namespace revolve
     class NeuralNetwork
         : public Brain
     {
+      /// \brief The pool reads the network layout when batching it
+      friend class BrainPool;
+
       /// \brief Constructor
       /// \param[in] _modelName Name of the robot
       /// \param[in] _node The brain node
@@ -80,6 +91,16 @@ namespace revolve
           const std::vector< MotorPtr > &_motors,
           const std::vector< SensorPtr > &_sensors);
 
+      /// \brief Constructor for a network outside of a simulation, which
+      /// neither listens to modifications nor joins a brain pool
+      /// \param[in] _network Description of the network
+      /// \param[in] _motors Motors receiving the outputs
+      /// \param[in] _sensors Sensors feeding the inputs
+      public: NeuralNetwork(
+          const revolve::msgs::NeuralNetwork &_network,
+          const std::vector< MotorPtr > &_motors,
+          const std::vector< SensorPtr > &_sensors);
+
       /// \brief Destructor
       public: virtual ~NeuralNetwork();
 
@@ -97,73 +118,232 @@ namespace revolve
       /// \brief Steps the neural network
       protected: void Step(const double _time);
 
+      /// \brief Non-input neurons of one type that are evaluated together
+      protected: struct NeuronBatch
+      {
+        /// \brief Type shared by the neurons
+        unsigned int type;
+
+        /// \brief Indices of the neurons among the non-input neurons
+        std::vector< unsigned int > neurons;
+
+        /// \brief Params of the neurons, param `p` of the `k`-th neuron is
+        /// at `p * neurons.size() + k`
+        std::vector< double > params;
+      };
+
+      /// \brief Everything that describes the network, as opposed to its
+      /// state.
+      /// \details A layout is never changed once it has been published.
+      /// `Modify()` edits a copy of the latest layout and publishes the copy,
+      /// `Update()` switches to it before its next step.
+      protected: struct Layout
+      {
+        /// \brief Constructor
+        Layout();
+
+        /// \brief Connection weights in compressed sparse row format.
+        /// \details There is one row for every non-input neuron, i.e. a
+        /// weight target, and one column for every neuron in the state
+        /// vector. Both are sized from the actual number of neurons in the
+        /// genome and only the existing connections are stored.
+        SparseMatrix weights;
+
+        /// \brief Padded row-major copy of `weights` for dense networks
+        DenseMatrix denseWeights;
+
+        /// \brief Whether `Step()` uses `denseWeights` instead of `weights`
+        bool useDense;
+
+        /// \brief Copy of `weights` with kernels specialized for its size,
+        /// for networks of at most `FixedMatrix::MAX_COLUMNS` neurons
+        FixedMatrix fixedWeights;
+
+        /// \brief Whether `Step()` uses `fixedWeights`, which takes
+        /// precedence over the double representations
+        bool useFixed;
+
+        /// \brief Storage precision of the weights, from the `precision`
+        /// attribute of `rv:controller` (`double`, `float` or `int8`)
+        WeightPrecision precision;
+
+        /// \brief Float or int8 copy of `weights`
+        CompactMatrix compactWeights;
+
+        /// \brief Whether `Step()` uses `compactWeights`, which is the case
+        /// whenever the precision is reduced
+        bool useCompact;
+
+        /// \brief Whether the connections between non-input neurons form a
+        /// directed acyclic graph
+        /// \details Acyclic networks are evaluated once per step in
+        /// topological order, in place in the current state. Cyclic
+        /// networks compute the next state from the current one (double
+        /// buffered).
+        bool acyclic;
+
+        /// \brief Topological order of the non-input neurons, empty unless
+        /// the network is acyclic
+        std::vector< unsigned int > order;
+
+        /// \brief Neurons grouped by type, so every activation function
+        /// runs over a contiguous array instead of switching per neuron
+        /// \details Acyclic networks get one batch per type and topological
+        /// level, in level order, so no batch depends on a later one.
+        std::vector< NeuronBatch > batches;
+
+        /// \brief Number of neurons in the largest batch
+        size_t largestBatch;
+
+        /// \brief Type of each non-input neuron
+        /// \details Types and params are stored without gaps, meaning the
+        /// first `m` entries are for output neurons, followed by `n` entries
+        /// for hidden neurons. If a hidden neuron is removed, the items
+        /// beyond it are moved back.
+        std::vector< unsigned int > types;
+
+        /// \brief Params for hidden and output neurons, quantity depends on
+        /// the type of neuron
+        std::vector< double > params;
+
+        /// \brief Identifies the neuron in every column of the state vector
+        /// across layouts, so the state can be carried over to a new one.
+        /// \details New neurons get increasing keys and are appended, hence
+        /// the keys are always in ascending order.
+        std::vector< unsigned int > keys;
+
+        /// \brief Key of the next neuron to be added
+        unsigned int nextKey;
+
+        /// \brief Stores the type of each neuron ID
+        std::map< std::string, std::string > layerMap;
+
+        /// \brief Stores the position of each neuron ID, relative to its
+        /// type
+        std::map< std::string, unsigned int > positionMap;
+
+        /// \brief The number of inputs
+        unsigned int nInputs;
+
+        /// \brief The number of outputs
+        unsigned int nOutputs;
+
+        /// \brief The number of hidden units
+        unsigned int nHidden;
+
+        /// \brief The number of non-inputs (i.e. nOutputs + nHidden)
+        unsigned int nNonInputs;
+      };
+
+      /// \brief Shared pointer to a published layout
+      protected: typedef std::shared_ptr< const Layout > ConstLayoutPtr;
+
+      /// \brief Computes the new state of the neurons in a batch
+      /// \param[in] _batch Index of the batch in the layout
+      /// \param[in] _sums Weighted input sum of every non-input neuron
+      /// \param[out] _out Non-input section of the state vector
+      /// \param[in] _time Current world time
+      /// \param[in] _dt Time since the previous step, zero after a reset
+      protected: void Activate(
+          const size_t _batch,
+          const double *_sums,
+          double *_out,
+          const double _time,
+          const double _dt);
+
       /// \brief Request handler to modify the neural network
       protected: void Modify(ConstModifyNeuralNetworkPtr &_request);
 
+      /// \brief Switches to a new layout, carrying over the state of the
+      /// neurons that exist in both
+      protected: void Adopt(const ConstLayoutPtr &_layout);
+
       /// \brief Network modification subscriber
       protected: ::gazebo::transport::SubscriberPtr alterSub_;
 
-      /// \brief Connection weights, separated into three arrays.
-      /// \note Only output and hidden neurons are weight targets.
-      /// \details Weights are stored with gaps, meaning that every neuron holds
-      /// entries for the maximum possible number of connections. This makes
-      /// restructuring the weights arrays when a hidden neuron is removed
-      /// slightly less cumbersome.
-      protected: double inputWeights_[
-          MAX_INPUT_NEURONS * (MAX_OUTPUT_NEURONS + MAX_HIDDEN_NEURONS)];
+      /// \brief Layout used by `Update()`
+      protected: ConstLayoutPtr layout_;
 
-      /// \brief output weights
-      protected: double outputWeights_[
-          MAX_OUTPUT_NEURONS * (MAX_OUTPUT_NEURONS + MAX_HIDDEN_NEURONS)];
+      /// \brief Latest layout, only accessed through the atomic shared
+      /// pointer functions
+      protected: ConstLayoutPtr published_;
 
-      /// \brief hidden weights
-      protected: double hiddenWeights_[
-          MAX_HIDDEN_NEURONS * (MAX_OUTPUT_NEURONS + MAX_HIDDEN_NEURONS)];
+      /// \brief Set when `published_` has been replaced and not adopted yet
+      protected: std::atomic< bool > modified_;
 
-      /// \brief Type of each non-input neuron
-      /// \details Unlike weights, types, params and current states are stored
-      /// without gaps, meaning the first `m` entries are for output neurons,
-      /// followed by `n` entries for hidden neurons. If a hidden neuron is
-      /// removed, the items beyond it are moved back.
-      protected: unsigned int types_[(MAX_OUTPUT_NEURONS + MAX_HIDDEN_NEURONS)];
+      /// \brief Weighted input sum of every non-input neuron
+      protected: std::vector< double > activations_;
 
-      /// \brief Params for hidden and output neurons, quantity depends on
-      /// the type of neuron
-      protected: double params_[
-          MAX_NEURON_PARAMS * (MAX_OUTPUT_NEURONS + MAX_HIDDEN_NEURONS)];
+      /// \brief Activation arguments and inputs of the batch being
+      /// evaluated
+      protected: std::vector< double > scratch_;
 
-      /// \brief Output states arrays for the current state and the next state.
-      protected: double state1_[MAX_OUTPUT_NEURONS + MAX_HIDDEN_NEURONS];
+      /// \brief Zero padded input of `Layout::denseWeights`
+      /// \details Kept here rather than in the matrix, because the layout
+      /// is shared with `Modify()` and must not be written once published.
+      protected: std::vector< double > denseInput_;
 
-      protected: double state2_[MAX_OUTPUT_NEURONS + MAX_HIDDEN_NEURONS];
+      /// \brief Zero padded input of `Layout::compactWeights`
+      protected: std::vector< float > compactInput_;
 
-      /// \brief One input state for each input neuron
-      protected: double input_[MAX_INPUT_NEURONS];
+      /// \brief Phasors of every `OSCILLATOR` batch, empty for the others
+      protected: std::vector< OscillatorBank > oscillators_;
 
-      /// \brief Used to determine the current state array.
-      /// \example false := state1, true := state2.
-      protected: bool flipState_;
+      /// \brief Integrated state of every `CTRNN_SIGMOID` batch, empty for
+      /// the others
+      protected: std::vector< std::vector< double > > ctrnnStates_;
+
+      /// \brief Minimum number of integration sub-steps per step, from the
+      /// `substeps` attribute of `rv:controller`
+      protected: unsigned int substeps_;
 
-      /// \brief Stores the type of each neuron ID
-      protected: std::map< std::string, std::string > layerMap_;
+      /// \brief Time of the previous step
+      protected: double lastTime_;
 
-      /// \brief Stores the position of each neuron ID, relative to its type
-      protected: std::map< std::string, unsigned int > positionMap_;
+      /// \brief Accuracy of the activation functions, from the `accuracy`
+      /// attribute of `rv:controller` (`exact`, `fast` or `ultra_fast`)
+      protected: ActivationAccuracy accuracy_;
 
-      /// \brief The number of inputs
-      protected: unsigned int nInputs_;
+      /// \brief State vectors for the current state and the next state.
+      /// \details A state vector holds the inputs, followed by the outputs
+      /// and the hidden neurons, which matches the column order of
+      /// `Layout::weights`. Sensors write directly into the input section of
+      /// the current state.
+      protected: std::vector< double > state1_;
 
-      /// \brief The number of outputs
-      protected: unsigned int nOutputs_;
+      protected: std::vector< double > state2_;
 
-      /// \brief The number of hidden units
-      protected: unsigned int nHidden_;
+      /// \brief Used to determine the current state array.
+      /// \example false := state1, true := state2.
+      protected: bool flipState_;
+
+      /// \brief Pool evaluating this network together with the other robots
+      /// in the world, null when the network is stepped by itself
+      protected: BrainPoolPtr pool_;
+
+      /// \brief Recorder of the state after every step, null unless the
+      /// `trace` attribute of `rv:controller` names a directory
+      protected: TraceRecorderPtr recorder_;
+
+      /// \brief Builds a layout from a network description
+      /// \param[out] _layout Empty layout
+      /// \param[in] _network Neurons and connections
+      /// \param[in] _motors Motors, in the order of the output neurons
+      /// \param[in] _sensors Sensors, in the order of the input neurons
+      private: static void Build(
+          Layout &_layout,
+          const revolve::msgs::NeuralNetwork &_network,
+          const std::vector< MotorPtr > &_motors,
+          const std::vector< SensorPtr > &_sensors);
 
-      /// \brief The number of non-inputs (i.e. nOutputs + nHidden)
-      protected: unsigned int nNonInputs_;
+      /// \brief Selects the weights representation, the evaluation order and
+      /// the batches of a layout after it has been built or modified
+      private: static void Compile(Layout &_layout);
 
       /// \brief Connection helper
-      private: void ConnectionHelper(
+      /// \return The position of the connection within `weights`
+      private: static SparseMatrix::Triplet ConnectionHelper(
+          Layout &_layout,
           const std::string &_src,
           const std::string &_dst,
           const double _weight);
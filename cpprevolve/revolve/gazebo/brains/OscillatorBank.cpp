@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Bank of sine oscillators advanced by complex rotation.
+ * Date: October 16, 2026
+ *
+ */
+
+#include <cmath>
+
+#include "OscillatorBank.h"
+
+using namespace revolve::gazebo;
+
+/// \brief Relative difference between two time steps that still counts as
+/// the same step
+static const double STEP_TOLERANCE = 1e-9;
+
+/////////////////////////////////////////////////
+OscillatorBank::OscillatorBank()
+    : time_(0)
+    , step_(0)
+    , ticks_(0)
+    , seeded_(false)
+    , accuracy_(EXACT)
+{
+}
+
+/////////////////////////////////////////////////
+void OscillatorBank::Reset(
+    const double *_periods,
+    const double *_phaseOffsets,
+    const size_t _n,
+    const ActivationAccuracy _accuracy)
+{
+  this->omegas_.resize(_n);
+  this->origins_.resize(_n);
+  for (size_t k = 0; k < _n; ++k)
+  {
+    this->omegas_[k] = 2.0 * M_PI / _periods[k];
+    this->origins_[k] = _periods[k] * _phaseOffsets[k];
+  }
+  this->cos_.assign(_n, 1);
+  this->sin_.assign(_n, 0);
+  this->rotationCos_.assign(_n, 1);
+  this->rotationSin_.assign(_n, 0);
+  this->angles_.assign(_n, 0);
+
+  this->accuracy_ = _accuracy;
+  this->step_ = 0;
+  this->seeded_ = false;
+}
+
+/////////////////////////////////////////////////
+const double *OscillatorBank::Advance(const double _time)
+{
+  const auto n = this->omegas_.size();
+  const auto step = _time - this->time_;
+
+  if (not this->seeded_ or ++this->ticks_ >= RESEED_INTERVAL or step <= 0 or
+      std::fabs(step - this->step_) > STEP_TOLERANCE * this->step_)
+  {
+    // Only a positive step is worth remembering, a backwards jump keeps
+    // the current rotations for when the time moves on normally again.
+    if (this->seeded_ and step > 0 and
+        std::fabs(step - this->step_) > STEP_TOLERANCE * this->step_)
+    {
+      this->SetStep(step);
+    }
+    this->Seed(_time);
+    return this->sin_.data();
+  }
+
+  double *__restrict c = this->cos_.data();
+  double *__restrict s = this->sin_.data();
+  const double *__restrict rc = this->rotationCos_.data();
+  const double *__restrict rs = this->rotationSin_.data();
+  for (size_t k = 0; k < n; ++k)
+  {
+    auto cosine = c[k] * rc[k] - s[k] * rs[k];
+    s[k] = s[k] * rc[k] + c[k] * rs[k];
+    c[k] = cosine;
+  }
+
+  if (this->ticks_ % RENORMALIZE_INTERVAL == 0)
+  {
+    // One Newton step towards 1 / |z|, the magnitude is within rounding
+    // error of one so this is as good as dividing by the exact norm.
+    for (size_t k = 0; k < n; ++k)
+    {
+      auto scale = 0.5 * (3.0 - (c[k] * c[k] + s[k] * s[k]));
+      c[k] *= scale;
+      s[k] *= scale;
+    }
+  }
+
+  this->time_ = _time;
+  return this->sin_.data();
+}
+
+/////////////////////////////////////////////////
+void OscillatorBank::Seed(const double _time)
+{
+  const auto n = this->omegas_.size();
+  for (size_t k = 0; k < n; ++k)
+  {
+    this->angles_[k] = this->omegas_[k] * (_time - this->origins_[k]);
+  }
+  Activations::Sin(
+      this->angles_.data(), this->sin_.data(), n, this->accuracy_);
+
+  // cos(x) = sin(x + pi / 2)
+  for (size_t k = 0; k < n; ++k)
+  {
+    this->angles_[k] += M_PI / 2;
+  }
+  Activations::Sin(
+      this->angles_.data(), this->cos_.data(), n, this->accuracy_);
+
+  this->time_ = _time;
+  this->ticks_ = 0;
+  this->seeded_ = true;
+}
+
+/////////////////////////////////////////////////
+void OscillatorBank::SetStep(const double _step)
+{
+  const auto n = this->omegas_.size();
+  for (size_t k = 0; k < n; ++k)
+  {
+    this->angles_[k] = this->omegas_[k] * _step;
+  }
+  Activations::Sin(
+      this->angles_.data(), this->rotationSin_.data(), n, this->accuracy_);
+  for (size_t k = 0; k < n; ++k)
+  {
+    this->angles_[k] += M_PI / 2;
+  }
+  Activations::Sin(
+      this->angles_.data(), this->rotationCos_.data(), n, this->accuracy_);
+
+  this->step_ = _step;
+}
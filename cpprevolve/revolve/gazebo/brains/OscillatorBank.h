@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Bank of sine oscillators advanced by complex rotation.
+ * Date: October 16, 2026
+ *
+ */
+
+#ifndef REVOLVE_GAZEBO_BRAIN_OSCILLATORBANK_H_
+#define REVOLVE_GAZEBO_BRAIN_OSCILLATORBANK_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "Activations.h"
+
+namespace revolve
+{
+  namespace gazebo
+  {
+    /// \brief Computes `sin((2 pi / period) * (t - period * phaseOffset))`
+    /// for a set of oscillators without evaluating sin on every tick.
+    /// \details Every oscillator is kept as a unit phasor `(cos, sin)`. As
+    /// long as the time advances by the same step, a tick multiplies each
+    /// phasor by its fixed rotation `exp(i * omega * step)`, which is four
+    /// multiplications per oscillator over contiguous arrays. The phasors
+    /// are renormalized every `RENORMALIZE_INTERVAL` ticks to bound the
+    /// growth of their magnitude, and reseeded from the absolute time every
+    /// `RESEED_INTERVAL` ticks to bound the accumulated phase error. A time
+    /// that does not advance by the current step (the first ticks, a reset,
+    /// a change of update rate) reseeds the phasors as well.
+    class OscillatorBank
+    {
+      /// \brief Ticks between two renormalizations
+      public: static const unsigned int RENORMALIZE_INTERVAL = 64;
+
+      /// \brief Ticks between two reseeds from the absolute time
+      public: static const unsigned int RESEED_INTERVAL = 10000;
+
+      /// \brief Constructor
+      public: OscillatorBank();
+
+      /// \brief Sets the oscillators and forgets the current phasors
+      /// \param[in] _periods Period of every oscillator in seconds
+      /// \param[in] _phaseOffsets Phase offset of every oscillator, as a
+      /// fraction of its period
+      /// \param[in] _n Number of oscillators
+      /// \param[in] _accuracy Accuracy of the sin used when seeding
+      public: void Reset(
+          const double *_periods,
+          const double *_phaseOffsets,
+          const size_t _n,
+          const ActivationAccuracy _accuracy);
+
+      /// \brief Moves all oscillators to a point in time
+      /// \param[in] _time Absolute time in seconds
+      /// \return The sine of every oscillator, valid until the next call
+      public: const double *Advance(const double _time);
+
+      /// \brief Computes the phasors directly from the absolute time
+      private: void Seed(const double _time);
+
+      /// \brief Computes the rotation of every oscillator for one step
+      private: void SetStep(const double _step);
+
+      /// \brief Angular frequency of every oscillator
+      private: std::vector< double > omegas_;
+
+      /// \brief Time at which every oscillator is at phase zero
+      private: std::vector< double > origins_;
+
+      /// \brief Real and imaginary parts of the phasors
+      private: std::vector< double > cos_;
+
+      private: std::vector< double > sin_;
+
+      /// \brief Real and imaginary parts of the rotation for one step
+      private: std::vector< double > rotationCos_;
+
+      private: std::vector< double > rotationSin_;
+
+      /// \brief Arguments of the sin while seeding
+      private: std::vector< double > angles_;
+
+      /// \brief Time of the current phasors
+      private: double time_;
+
+      /// \brief Time step of the current rotations, zero if unknown
+      private: double step_;
+
+      /// \brief Ticks since the last reseed
+      private: unsigned int ticks_;
+
+      /// \brief Whether the phasors hold a valid state
+      private: bool seeded_;
+
+      /// \brief Accuracy of the sin used when seeding
+      private: ActivationAccuracy accuracy_;
+    };
+  }
+}
+
+#endif  // REVOLVE_GAZEBO_BRAIN_OSCILLATORBANK_H_
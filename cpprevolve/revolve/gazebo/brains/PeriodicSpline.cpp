@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Batched periodic cubic splines over uniformly spaced control
+ *              points.
+ * Date: October 16, 2026
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "PeriodicSpline.h"
+
+using namespace revolve::gazebo;
+
+/// Lower left corner of the Sherman-Morrison decomposition, see
+/// Numerical Recipes, section 2.7
+static const double GAMMA = -4.0;
+
+/////////////////////////////////////////////////
+PeriodicSpline::PeriodicSpline()
+    : points_(0)
+    , splines_(0)
+    , period_(1)
+    , h_(1)
+{
+}
+
+/////////////////////////////////////////////////
+void PeriodicSpline::Factorize(const size_t _points)
+{
+  const auto n = _points;
+  this->pivots_.assign(n, 0);
+  this->correction_.assign(n, 0);
+  if (n < 3)
+  {
+    return;
+  }
+
+  // The cyclic matrix is the tridiagonal matrix T with the diagonal
+  // corners changed to 4 - GAMMA and 4 - 1 / GAMMA, plus the outer product
+  // of u = (GAMMA, 0, ..., 0, 1) and v = (1, 0, ..., 0, 1 / GAMMA).
+  // The off-diagonals of T are one, so the Thomas factors reduce to the
+  // inverted pivots.
+  for (size_t i = 0; i < n; ++i)
+  {
+    auto diagonal = i == 0 ? 4.0 - GAMMA
+                    : i == n - 1 ? 4.0 - 1.0 / GAMMA
+                    : 4.0;
+    this->pivots_[i] = 1.0 / (diagonal - (i > 0 ? this->pivots_[i - 1] : 0));
+  }
+
+  // z = T^-1 u
+  auto &z = this->correction_;
+  z[0] = GAMMA * this->pivots_[0];
+  for (size_t i = 1; i < n; ++i)
+  {
+    z[i] = ((i == n - 1 ? 1.0 : 0.0) - z[i - 1]) * this->pivots_[i];
+  }
+  for (size_t i = n - 1; i-- > 0;)
+  {
+    z[i] -= this->pivots_[i] * z[i + 1];
+  }
+
+  auto denominator = 1.0 + z[0] + z[n - 1] / GAMMA;
+  for (auto &value : z)
+  {
+    value /= denominator;
+  }
+}
+
+/////////////////////////////////////////////////
+void PeriodicSpline::Fit(
+    const double *_y,
+    const size_t _points,
+    const size_t _splines,
+    const double _period)
+{
+  const auto n = _points;
+  const auto S = _splines;
+  if (n not_eq this->points_)
+  {
+    this->Factorize(n);
+  }
+  this->points_ = n;
+  this->splines_ = S;
+  this->period_ = _period;
+  this->h_ = _period / std::max(n, static_cast< size_t >(1));
+  this->moments_.assign(n * S, 0);
+  this->coefficients_.assign(4 * n * S, 0);
+  if (n == 0)
+  {
+    return;
+  }
+
+  const auto h = this->h_;
+  const auto scale = 6.0 / (h * h);
+  auto M = this->moments_.data();
+
+  // Right hand side
+  for (size_t i = 0; i < n; ++i)
+  {
+    auto previous = _y + ((i + n - 1) % n) * S;
+    auto current = _y + i * S;
+    auto next = _y + ((i + 1) % n) * S;
+    for (size_t s = 0; s < S; ++s)
+    {
+      M[i * S + s] = scale * (previous[s] - 2.0 * current[s] + next[s]);
+    }
+  }
+
+  if (n == 2)
+  {
+    // Both neighbours of a point are the other point, which leaves
+    // [4 2; 2 4] M = r.
+    for (size_t s = 0; s < S; ++s)
+    {
+      auto r0 = M[s];
+      auto r1 = M[S + s];
+      M[s] = (4.0 * r0 - 2.0 * r1) / 12.0;
+      M[S + s] = (4.0 * r1 - 2.0 * r0) / 12.0;
+    }
+  }
+  else if (n >= 3)
+  {
+    // Forward sweep and back substitution of T x = r, one row of all
+    // splines at a time
+    const auto pivots = this->pivots_.data();
+    for (size_t s = 0; s < S; ++s)
+    {
+      M[s] *= pivots[0];
+    }
+    for (size_t i = 1; i < n; ++i)
+    {
+      auto row = M + i * S;
+      auto above = row - S;
+      for (size_t s = 0; s < S; ++s)
+      {
+        row[s] = (row[s] - above[s]) * pivots[i];
+      }
+    }
+    for (size_t i = n - 1; i-- > 0;)
+    {
+      auto row = M + i * S;
+      auto below = row + S;
+      for (size_t s = 0; s < S; ++s)
+      {
+        row[s] -= pivots[i] * below[s];
+      }
+    }
+
+    // Sherman-Morrison correction, M -= (v . x) z / (1 + v . z). The
+    // factor depends on the first and the last row, so they go last.
+    const auto z = this->correction_.data();
+    auto last = M + (n - 1) * S;
+    for (size_t i = 1; i < n - 1; ++i)
+    {
+      auto row = M + i * S;
+      for (size_t s = 0; s < S; ++s)
+      {
+        row[s] -= (M[s] + last[s] / GAMMA) * z[i];
+      }
+    }
+    for (size_t s = 0; s < S; ++s)
+    {
+      auto factor = M[s] + last[s] / GAMMA;
+      M[s] -= factor * z[0];
+      last[s] -= factor * z[n - 1];
+    }
+  }
+
+  // Polynomial of every segment
+  for (size_t i = 0; i < n; ++i)
+  {
+    auto j = (i + 1) % n;
+    auto c = this->coefficients_.data() + 4 * i * S;
+    for (size_t s = 0; s < S; ++s)
+    {
+      auto y0 = _y[i * S + s];
+      auto y1 = _y[j * S + s];
+      auto m0 = M[i * S + s];
+      auto m1 = M[j * S + s];
+      c[s] = y0;
+      c[S + s] = (y1 - y0) / h - h * (2.0 * m0 + m1) / 6.0;
+      c[2 * S + s] = m0 / 2.0;
+      c[3 * S + s] = (m1 - m0) / (6.0 * h);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void PeriodicSpline::Evaluate(
+    const double _x,
+    double *_out) const
+{
+  const auto S = this->splines_;
+  if (this->points_ == 0)
+  {
+    std::fill(_out, _out + S, 0.0);
+    return;
+  }
+
+  auto x = std::fmod(_x, this->period_);
+  if (x < 0)
+  {
+    x += this->period_;
+  }
+  auto i = std::min(
+      static_cast< size_t >(x / this->h_), this->points_ - 1);
+  auto t = x - i * this->h_;
+
+  auto c = this->coefficients_.data() + 4 * i * S;
+  for (size_t s = 0; s < S; ++s)
+  {
+    _out[s] = c[s] + t * (c[S + s] + t * (c[2 * S + s] + t * c[3 * S + s]));
+  }
+}
+
+/////////////////////////////////////////////////
+void PeriodicSpline::Sample(
+    const size_t _samples,
+    double *_out) const
+{
+  const auto step = this->period_ / _samples;
+  for (size_t k = 0; k < _samples; ++k)
+  {
+    this->Evaluate(step * k, _out + k * this->splines_);
+  }
+}
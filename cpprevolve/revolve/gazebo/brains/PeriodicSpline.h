@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Batched periodic cubic splines over uniformly spaced control
+ *              points.
+ * Date: October 16, 2026
+ *
+ */
+
+#ifndef REVOLVE_GAZEBO_BRAIN_PERIODICSPLINE_H_
+#define REVOLVE_GAZEBO_BRAIN_PERIODICSPLINE_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace revolve
+{
+  namespace gazebo
+  {
+    /// \brief A batch of periodic cubic splines sharing their knots.
+    /// \details Spline `s` passes through `n` control points `y[i][s]` at
+    /// `x = i * h`, `h = period / n`, and closes on itself at `x = period`,
+    /// with continuous first and second derivatives everywhere. This is the
+    /// `gsl_interp_cspline_periodic` interpolation of the `n + 1` points
+    /// with the first one repeated at the end.
+    ///
+    /// The second derivatives solve the cyclic tridiagonal system
+    /// `M[i-1] + 4 M[i] + M[i+1] = 6 (y[i-1] - 2 y[i] + y[i+1]) / h^2`.
+    /// Its matrix only depends on `n`, so the Thomas factors and the
+    /// Sherman-Morrison correction vector are computed once per size, and
+    /// every sweep of the solve runs across all splines of the batch, which
+    /// are stored as a structure of arrays.
+    class PeriodicSpline
+    {
+      /// \brief Constructor
+      public: PeriodicSpline();
+
+      /// \brief Fits the splines
+      /// \param[in] _y Control points, point `i` of spline `s` at
+      /// `i * _splines + s`
+      /// \param[in] _points Number of control points per spline
+      /// \param[in] _splines Number of splines
+      /// \param[in] _period Length of one cycle
+      public: void Fit(
+          const double *_y,
+          const size_t _points,
+          const size_t _splines,
+          const double _period);
+
+      /// \brief Evaluates every spline at one position
+      /// \param[in] _x Position, wrapped into `[0, period)`
+      /// \param[out] _out Value of every spline
+      public: void Evaluate(
+          const double _x,
+          double *_out) const;
+
+      /// \brief Evaluates every spline at `_samples` uniformly spaced
+      /// positions `k * period / _samples`
+      /// \param[in] _samples Number of samples
+      /// \param[out] _out Sample `k` of spline `s` at `k * Splines() + s`
+      public: void Sample(
+          const size_t _samples,
+          double *_out) const;
+
+      /// \return Number of control points per spline
+      public: size_t Points() const { return this->points_; }
+
+      /// \return Number of splines
+      public: size_t Splines() const { return this->splines_; }
+
+      /// \brief Computes the Thomas factors for `_points` control points
+      private: void Factorize(const size_t _points);
+
+      /// \brief Number of control points per spline
+      private: size_t points_;
+
+      /// \brief Number of splines
+      private: size_t splines_;
+
+      /// \brief Length of one cycle
+      private: double period_;
+
+      /// \brief Distance between two control points
+      private: double h_;
+
+      /// \brief Inverted pivots of the modified tridiagonal matrix
+      private: std::vector< double > pivots_;
+
+      /// \brief Sherman-Morrison correction vector, already divided by its
+      /// denominator
+      private: std::vector< double > correction_;
+
+      /// \brief Second derivatives, point-major like the control points
+      private: std::vector< double > moments_;
+
+      /// \brief Polynomial coefficients of every segment. Coefficient `k` of
+      /// segment `i` of spline `s` is at `(4 * i + k) * splines_ + s`, for
+      /// `y = c0 + t (c1 + t (c2 + t c3))` with `t` measured from the start
+      /// of the segment.
+      private: std::vector< double > coefficients_;
+    };
+  }
+}
+
+#endif  // REVOLVE_GAZEBO_BRAIN_PERIODICSPLINE_H_
@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Fixed-capacity archive of the best spline policies, ranked
+ *              by fitness.
+ * Date: October 16, 2026
+ *
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#include "PolicyArchive.h"
+
+using namespace revolve::gazebo;
+
+std::map< std::string, std::weak_ptr< PolicyArchive > >
+    PolicyArchive::registry_;
+
+boost::mutex PolicyArchive::registryMutex_;
+
+/////////////////////////////////////////////////
+PolicyArchive::PolicyArchive(
+    const size_t _capacity,
+    const size_t _splines,
+    const size_t _points)
+    : capacity_(_capacity)
+    , splines_(_splines)
+    , points_(_points)
+    , stride_(_splines * _points)
+    , evaluations_(0)
+    , arena_(_capacity * _splines * _points, 0)
+    , fitness_(_capacity, 0)
+{
+  this->ranking_.reserve(_capacity);
+}
+
+/////////////////////////////////////////////////
+std::shared_ptr< PolicyArchive > PolicyArchive::Shared(
+    const std::string &_key,
+    const size_t _capacity,
+    const size_t _splines,
+    const size_t _points)
+{
+  boost::mutex::scoped_lock lock(PolicyArchive::registryMutex_);
+
+  auto archive = PolicyArchive::registry_[_key].lock();
+  if (not archive)
+  {
+    archive = std::make_shared< PolicyArchive >(_capacity, _splines, _points);
+    PolicyArchive::registry_[_key] = archive;
+  }
+  else if (archive->splines_ not_eq _splines)
+  {
+    std::cerr << "Robots of population `" << _key << "` need "
+              << archive->splines_ << " motors, not " << _splines << '.'
+              << std::endl;
+    throw std::runtime_error("Robot brain error");
+  }
+  return archive;
+}
+
+/////////////////////////////////////////////////
+bool PolicyArchive::Insert(
+    const double _fitness,
+    const double *_policy)
+{
+  ++this->evaluations_;
+  if (this->capacity_ == 0)
+  {
+    return false;
+  }
+
+  // Slots fill up in order until the archive is full, after that the new
+  // policy takes the slot of the worst one.
+  size_t slot;
+  if (this->ranking_.size() < this->capacity_)
+  {
+    slot = this->ranking_.size();
+  }
+  else
+  {
+    if (not (_fitness > this->fitness_[this->ranking_.back()]))
+    {
+      return false;
+    }
+    slot = this->ranking_.back();
+    this->ranking_.pop_back();
+  }
+
+  std::copy(_policy, _policy + this->stride_,
+            this->arena_.begin() + slot * this->stride_);
+  this->fitness_[slot] = _fitness;
+
+  // Policies of equal fitness keep their order of arrival
+  auto position = std::upper_bound(
+      this->ranking_.begin(), this->ranking_.end(), _fitness,
+      [this](const double _value, const size_t _slot)
+      {
+        return _value > this->fitness_[_slot];
+      });
+  this->ranking_.insert(position, slot);
+  return true;
+}
+
+/////////////////////////////////////////////////
+void PolicyArchive::Restore(
+    const size_t _points,
+    const size_t _evaluations,
+    const size_t _ranked,
+    const double *_fitness,
+    const double *_policies)
+{
+  this->points_ = _points;
+  this->stride_ = this->splines_ * _points;
+  this->arena_.assign(this->capacity_ * this->stride_, 0);
+  this->ranking_.clear();
+
+  // Best first, so every insertion lands at the end of the ranking
+  for (size_t r = 0; r < std::min(_ranked, this->capacity_); ++r)
+  {
+    this->Insert(_fitness[r], _policies + r * this->stride_);
+  }
+  this->evaluations_ = _evaluations;
+}
+
+/////////////////////////////////////////////////
+void PolicyArchive::Resample(
+    const size_t _points,
+    const double _period,
+    std::vector< double > &_policy)
+{
+  // Batch `p` holds the external policy for `p == 0` and slot `p - 1`
+  // otherwise. Unoccupied slots are resampled as well, which keeps the
+  // indexing simple and costs nothing that matters.
+  const auto S = this->splines_;
+  const auto numPolicies = this->capacity_ + 1;
+  const auto batchSize = numPolicies * S;
+  this->controlPoints_.resize(this->points_ * batchSize);
+  for (size_t p = 0; p < numPolicies; ++p)
+  {
+    auto policy = p == 0 ? _policy.data()
+                         : this->arena_.data() + (p - 1) * this->stride_;
+    for (size_t i = 0; i < S; ++i)
+    {
+      for (size_t j = 0; j < this->points_; ++j)
+      {
+        this->controlPoints_[j * batchSize + p * S + i] =
+            policy[i * this->points_ + j];
+      }
+    }
+  }
+  this->spline_.Fit(
+      this->controlPoints_.data(), this->points_, batchSize, _period);
+
+  this->samples_.resize(_points * batchSize);
+  this->spline_.Sample(_points, this->samples_.data());
+
+  this->points_ = _points;
+  this->stride_ = S * _points;
+  this->arena_.resize(this->capacity_ * this->stride_);
+  _policy.resize(this->stride_);
+  for (size_t p = 0; p < numPolicies; ++p)
+  {
+    auto policy = p == 0 ? _policy.data()
+                         : this->arena_.data() + (p - 1) * this->stride_;
+    for (size_t i = 0; i < S; ++i)
+    {
+      for (size_t j = 0; j < _points; ++j)
+      {
+        policy[i * _points + j] = this->samples_[j * batchSize + p * S + i];
+      }
+    }
+  }
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Fixed-capacity archive of the best spline policies, ranked
+ *              by fitness.
+ * Date: October 16, 2026
+ *
+ */
+
+#ifndef REVOLVE_GAZEBO_BRAIN_POLICYARCHIVE_H_
+#define REVOLVE_GAZEBO_BRAIN_POLICYARCHIVE_H_
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+#include "PeriodicSpline.h"
+
+namespace revolve
+{
+  namespace gazebo
+  {
+    /// \brief The best policies found so far, best first.
+    /// \details A policy is a matrix of `Splines()` rows of `Points()`
+    /// control points, stored row after row. All policies live in one
+    /// arena of `Capacity()` slots, and `ranking_` lists the occupied slots
+    /// by descending fitness, so the policy and the fitness of any rank are
+    /// found in constant time and every policy is contiguous in memory.
+    ///
+    /// Robots of one population share an archive (see `Shared()`), so K
+    /// robots evaluate K candidates at the same time and every finished
+    /// evaluation ranks against the results of all of them.
+    class PolicyArchive
+    {
+      /// \brief Constructor
+      /// \param[in] _capacity Maximum number of policies
+      /// \param[in] _splines Number of splines per policy
+      /// \param[in] _points Number of control points per spline
+      public: PolicyArchive(
+          const size_t _capacity,
+          const size_t _splines,
+          const size_t _points);
+
+      /// \brief Returns the archive of a population, creating it for its
+      /// first robot
+      /// \param[in] _key World and population name
+      /// \param[in] _capacity Maximum number of policies
+      /// \param[in] _splines Number of splines per policy, which has to match
+      /// the other robots of the population
+      /// \param[in] _points Initial number of control points per spline
+      public: static std::shared_ptr< PolicyArchive > Shared(
+          const std::string &_key,
+          const size_t _capacity,
+          const size_t _splines,
+          const size_t _points);
+
+      /// \brief Adds a policy, dropping the worst one if the archive is full
+      /// \param[in] _fitness Fitness of the policy
+      /// \param[in] _policy `Splines() * Points()` control points
+      /// \return False if the archive is full and the policy is not better
+      /// than the worst one, in which case nothing changes
+      public: bool Insert(
+          const double _fitness,
+          const double *_policy);
+
+      /// \brief Replaces the contents, e.g. from a checkpoint
+      /// \param[in] _points Number of control points per spline
+      /// \param[in] _evaluations Number of evaluations so far
+      /// \param[in] _ranked Number of policies, at most `Capacity()`
+      /// \param[in] _fitness Fitness of every policy, best first
+      /// \param[in] _policies The policies, one after the other
+      public: void Restore(
+          const size_t _points,
+          const size_t _evaluations,
+          const size_t _ranked,
+          const double *_fitness,
+          const double *_policies);
+
+      /// \brief Resamples all policies of the archive and one more policy to
+      /// a new number of control points, in one batch
+      /// \param[in] _points New number of control points per spline
+      /// \param[in] _period Length of the spline cycle
+      /// \param[in,out] _policy Policy of the current number of points,
+      /// resized to the new one
+      public: void Resample(
+          const size_t _points,
+          const double _period,
+          std::vector< double > &_policy);
+
+      /// \return Fitness of the policy of the given rank, 0 being the best
+      public: double Fitness(const size_t _rank) const
+      {
+        return this->fitness_[this->ranking_[_rank]];
+      }
+
+      /// \return Control points of the policy of the given rank
+      public: const double *Policy(const size_t _rank) const
+      {
+        return this->arena_.data() + this->ranking_[_rank] * this->stride_;
+      }
+
+      /// \return Number of stored policies
+      public: size_t Size() const { return this->ranking_.size(); }
+
+      /// \return Maximum number of policies
+      public: size_t Capacity() const { return this->capacity_; }
+
+      /// \return Number of splines per policy
+      public: size_t Splines() const { return this->splines_; }
+
+      /// \return Number of control points per spline
+      public: size_t Points() const { return this->points_; }
+
+      /// \return Number of policies passed to `Insert()` so far, by all
+      /// robots sharing the archive
+      public: size_t Evaluations() const { return this->evaluations_; }
+
+      /// \brief Serializes the access of the robots of a population; every
+      /// other function expects it to be locked for a shared archive
+      public: boost::mutex &Mutex() { return this->mutex_; }
+
+      /// \brief Maximum number of policies
+      private: size_t capacity_;
+
+      /// \brief Number of splines per policy
+      private: size_t splines_;
+
+      /// \brief Number of control points per spline
+      private: size_t points_;
+
+      /// \brief Number of values per policy
+      private: size_t stride_;
+
+      /// \brief Number of policies passed to `Insert()`
+      private: size_t evaluations_;
+
+      /// \brief `capacity_` slots of `stride_` values
+      private: std::vector< double > arena_;
+
+      /// \brief Fitness of the policy in every slot
+      private: std::vector< double > fitness_;
+
+      /// \brief Occupied slots by descending fitness
+      private: std::vector< size_t > ranking_;
+
+      /// \brief Solver for `Resample()`
+      private: PeriodicSpline spline_;
+
+      /// \brief Control points of all policies, point-major
+      private: std::vector< double > controlPoints_;
+
+      /// \brief Samples of all policies, sample-major
+      private: std::vector< double > samples_;
+
+      /// \brief See `Mutex()`
+      private: boost::mutex mutex_;
+
+      /// \brief Shared archives by key
+      private: static std::map< std::string, std::weak_ptr< PolicyArchive > >
+          registry_;
+
+      /// \brief Protects `registry_`
+      private: static boost::mutex registryMutex_;
+    };
+  }
+}
+
+#endif  // REVOLVE_GAZEBO_BRAIN_POLICYARCHIVE_H_
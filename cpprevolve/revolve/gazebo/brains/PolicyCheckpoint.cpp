@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Binary checkpoints of the learning state of RLPower.
+ * Date: October 16, 2026
+ *
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "PolicyCheckpoint.h"
+
+using namespace revolve::gazebo;
+
+/// Identifies a checkpoint and its format version
+static const char MAGIC[8] = {'R', 'V', 'C', 'H', 'K', 'P', 'T', '1'};
+
+/// Number of 8 byte fields before the current policy
+static const size_t HEADER_FIELDS = 6;
+
+/// Fewest control points of a policy, the initial spline size of RLPower
+static const uint64_t MIN_POINTS = 3;
+
+/// \brief Flushes the entries of the directory holding a file, so that a
+/// rename of the file survives a crash
+/// \return False if the directory cannot be flushed
+/////////////////////////////////////////////////
+static bool SyncDirectory(const std::string &_path)
+{
+  const auto separator = _path.find_last_of('/');
+  const auto directory = separator == std::string::npos
+                         ? std::string(".")
+                         : _path.substr(0, std::max(separator, static_cast< size_t >(1)));
+  auto fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+  if (fd < 0)
+  {
+    return false;
+  }
+  auto synced = fsync(fd) == 0;
+  close(fd);
+  return synced;
+}
+
+/////////////////////////////////////////////////
+void PolicyCheckpoint::Snapshot(
+    const double _sigma,
+    const std::vector< double > &_current,
+    const PolicyArchive &_archive,
+    State &_state)
+{
+  const auto policySize = _archive.Splines() * _archive.Points();
+  const auto ranked = _archive.Size();
+  _state.evaluations = _archive.Evaluations();
+  _state.splines = _archive.Splines();
+  _state.points = _archive.Points();
+  _state.sigma = _sigma;
+  _state.current.assign(_current.begin(), _current.begin() + policySize);
+  _state.fitness.resize(ranked);
+  _state.policies.resize(ranked * policySize);
+  for (size_t r = 0; r < ranked; ++r)
+  {
+    _state.fitness[r] = _archive.Fitness(r);
+    auto policy = _archive.Policy(r);
+    std::copy(
+        policy, policy + policySize, _state.policies.begin() + r * policySize);
+  }
+}
+
+/////////////////////////////////////////////////
+bool PolicyCheckpoint::Save(
+    const std::string &_path,
+    const State &_state)
+{
+  const uint64_t policySize = _state.splines * _state.points;
+  const uint64_t ranked = _state.fitness.size();
+  const size_t bytes = 8 * (HEADER_FIELDS + policySize +
+                            ranked * (1 + policySize));
+
+  const auto temporary = _path + ".tmp";
+  auto fd = open(temporary.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+  {
+    std::cerr << "Cannot create the checkpoint `" << temporary << "`."
+              << std::endl;
+    return false;
+  }
+  if (ftruncate(fd, static_cast< off_t >(bytes)) not_eq 0)
+  {
+    std::cerr << "Cannot resize the checkpoint `" << temporary << "`."
+              << std::endl;
+    close(fd);
+    return false;
+  }
+
+  auto memory = mmap(nullptr, bytes, PROT_WRITE, MAP_SHARED, fd, 0);
+  if (memory == MAP_FAILED)
+  {
+    std::cerr << "Cannot map the checkpoint `" << temporary << "`."
+              << std::endl;
+    close(fd);
+    return false;
+  }
+
+  auto fields = static_cast< uint64_t * >(memory);
+  std::memcpy(fields, MAGIC, 8);
+  fields[1] = _state.evaluations;
+  fields[2] = _state.splines;
+  fields[3] = _state.points;
+  fields[4] = ranked;
+  std::memcpy(fields + 5, &_state.sigma, 8);
+
+  auto values = reinterpret_cast< double * >(fields + HEADER_FIELDS);
+  values = std::copy(_state.current.begin(), _state.current.end(), values);
+  for (uint64_t r = 0; r < ranked; ++r)
+  {
+    *values++ = _state.fitness[r];
+    auto policy = _state.policies.begin() + r * policySize;
+    values = std::copy(policy, policy + policySize, values);
+  }
+
+  // The new contents have to be on disk before the rename makes them the
+  // checkpoint, and the rename itself before the checkpoint counts as saved
+  auto written = msync(memory, bytes, MS_SYNC) == 0;
+  munmap(memory, bytes);
+  written = fsync(fd) == 0 and written;
+  close(fd);
+  if (not written)
+  {
+    std::cerr << "Cannot write the checkpoint `" << temporary << "`: "
+              << std::strerror(errno) << std::endl;
+    std::remove(temporary.c_str());
+    return false;
+  }
+
+  if (std::rename(temporary.c_str(), _path.c_str()) not_eq 0)
+  {
+    std::cerr << "Cannot replace the checkpoint `" << _path << "`."
+              << std::endl;
+    return false;
+  }
+  if (not SyncDirectory(_path))
+  {
+    std::cerr << "Cannot flush the directory of the checkpoint `" << _path
+              << "`." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool PolicyCheckpoint::Load(
+    const std::string &_path,
+    State &_state)
+{
+  auto fd = open(_path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    return false;
+  }
+
+  struct stat status;
+  if (fstat(fd, &status) not_eq 0 or
+      static_cast< size_t >(status.st_size) < 8 * HEADER_FIELDS)
+  {
+    close(fd);
+    return false;
+  }
+
+  const auto bytes = static_cast< size_t >(status.st_size);
+  auto memory = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED)
+  {
+    return false;
+  }
+
+  auto fields = static_cast< const uint64_t * >(memory);
+  auto valid = std::memcmp(fields, MAGIC, 8) == 0;
+  if (valid)
+  {
+    _state.evaluations = fields[1];
+    _state.splines = fields[2];
+    _state.points = fields[3];
+    const auto ranked = fields[4];
+    std::memcpy(&_state.sigma, fields + 5, 8);
+
+    // Bound every size by the number of fields in the file before
+    // multiplying, so that corrupt sizes cannot overflow into a match
+    const uint64_t capacity = bytes / 8;
+    valid = _state.points >= MIN_POINTS and
+            _state.splines <= capacity / _state.points;
+    const auto policySize = valid ? _state.splines * _state.points : 0;
+    valid = valid and
+            ranked <= capacity / (1 + policySize) and
+            bytes == 8 * (HEADER_FIELDS + policySize +
+                          ranked * (1 + policySize));
+    if (valid)
+    {
+      auto values =
+          reinterpret_cast< const double * >(fields + HEADER_FIELDS);
+      _state.current.assign(values, values + policySize);
+      values += policySize;
+
+      _state.fitness.resize(ranked);
+      _state.policies.resize(ranked * policySize);
+      for (uint64_t r = 0; r < ranked; ++r)
+      {
+        _state.fitness[r] = *values++;
+        std::copy(values, values + policySize,
+                  _state.policies.begin() + r * policySize);
+        values += policySize;
+      }
+    }
+  }
+  munmap(memory, bytes);
+
+  if (not valid)
+  {
+    std::cerr << "`" << _path << "` is not a valid policy checkpoint."
+              << std::endl;
+  }
+  return valid;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Binary checkpoints of the learning state of RLPower.
+ * Date: October 16, 2026
+ *
+ */
+
+#ifndef REVOLVE_GAZEBO_BRAIN_POLICYCHECKPOINT_H_
+#define REVOLVE_GAZEBO_BRAIN_POLICYCHECKPOINT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "PolicyArchive.h"
+
+namespace revolve
+{
+  namespace gazebo
+  {
+    /// \brief Saves and loads the learning state of an RLPower brain.
+    /// \details A checkpoint is a flat file of 8 byte fields in host byte
+    /// order:
+    ///
+    ///     char[8] "RVCHKPT1"
+    ///     uint64 evaluations, splines, points, ranked
+    ///     double sigma
+    ///     double current[splines * points]
+    ///     ranked x (double fitness, double policy[splines * points])
+    ///
+    /// with the ranked policies best first and every policy stored spline
+    /// after spline. `Snapshot()` copies the learning state out of a locked
+    /// archive, so that `Save()` can write it without holding the lock.
+    /// `Save()` fills a memory-mapped temporary file, flushes
+    /// it to disk, renames it over the checkpoint and flushes the directory,
+    /// so a crash at any point leaves either the previous or the new
+    /// checkpoint. `Load()` maps the file read-only and rejects files with
+    /// fewer than 3 points per spline or sizes that do not match the file.
+    class PolicyCheckpoint
+    {
+      /// \brief Learning state read from a checkpoint
+      public: struct State
+      {
+        uint64_t evaluations;
+        uint64_t splines;
+        uint64_t points;
+        double sigma;
+        std::vector< double > current;
+        std::vector< double > fitness;
+
+        /// \brief Ranked policies, one after the other
+        std::vector< double > policies;
+      };
+
+      /// \brief Copies the learning state, reusing the buffers of `_state`
+      /// \param[in] _sigma Mutation step size
+      /// \param[in] _current Control points of the current policy
+      /// \param[in] _archive Ranked policies, whose number of evaluations
+      /// and points the checkpoint stores as well
+      /// \param[out] _state Learning state
+      public: static void Snapshot(
+          const double _sigma,
+          const std::vector< double > &_current,
+          const PolicyArchive &_archive,
+          State &_state);
+
+      /// \brief Writes a checkpoint
+      /// \param[in] _path Checkpoint file
+      /// \param[in] _state Learning state from `Snapshot()`
+      /// \return False if the file cannot be written
+      public: static bool Save(
+          const std::string &_path,
+          const State &_state);
+
+      /// \brief Reads a checkpoint
+      /// \param[in] _path Checkpoint file
+      /// \param[out] _state Learning state
+      /// \return False if the file does not exist or is not a valid
+      /// checkpoint
+      public: static bool Load(
+          const std::string &_path,
+          State &_state);
+    };
+  }
+}
+
+#endif  // REVOLVE_GAZEBO_BRAIN_POLICYCHECKPOINT_H_
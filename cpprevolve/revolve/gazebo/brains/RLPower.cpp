@@ -26,8 +26,8 @@
 #include <vector>
 #include <algorithm>
 
-#include <gsl/gsl_spline.h>
-
+#include "CheckpointWriter.h"
+#include "PolicyCheckpoint.h"
 #include "RLPower.h"
 #include "../motors/Motor.h"
 #include "../sensors/Sensor.h"
@@ -41,10 +41,15 @@ RLPower::RLPower(
     const ::gazebo::physics::ModelPtr &_model,
     const sdf::ElementPtr &_node,
     const std::vector< MotorPtr > &_motors,
-    const std::vector< SensorPtr > &_sensors)
-    : generationCounter_(0)
-    , cycleStartTime_(-1)
-    , startTime_(-1)
+    const std::vector< SensorPtr > &/* _sensors */)
+    : RLPower(
+        _node,
+        _model->GetWorld()->Name(),
+        [_model]()
+        {
+          return _model->WorldPose();
+        },
+        _motors)
 {
   // Create transport node
   this->node_.reset(new gz::transport::Node());
@@ -55,7 +60,78 @@ RLPower::RLPower(
 //      "~/" + _modelName + "/modify_spline_policy", &RLPower::Modify,
 //      this);
 
-  this->robot_ = _model;
+  this->evaluator_->Advertise(this->node_, _model->GetName());
+}
+
+/////////////////////////////////////////////////
+RLPower::RLPower(
+    const sdf::ElementPtr &_node,
+    const std::string &_worldName,
+    const PoseSource &_pose,
+    const std::vector< MotorPtr > &_motors)
+    : generationCounter_(0)
+    , cycleStartTime_(-1)
+    , startTime_(-1)
+    , pose_(_pose)
+    , checkpointInterval_(1)
+    , racing_(false)
+    , raceConfidence_(2.0)
+    , raceMinTime_(3.0)
+    , raceReady_(false)
+    , raceSpeed_(-1)
+    , raceWorst_(0)
+    , rng_(std::random_device()())
+{
+  // Robots with the same population name learn together
+  auto learner = _node->GetElement("rv:learner");
+  if (learner->HasAttribute("population"))
+  {
+    this->populationKey_ = _worldName + "/" +
+        learner->GetAttribute("population")->GetAsString();
+  }
+
+  // Checkpoints of the learning state, which is resumed from the last
+  // checkpoint unless another load path is given
+  if (learner->HasAttribute("checkpoint"))
+  {
+    this->checkpointPath_ = learner->GetAttribute("checkpoint")->GetAsString();
+    this->policyLoadPath_ = this->checkpointPath_;
+    this->checkpointWriter_.reset(new CheckpointWriter(this->checkpointPath_));
+    this->currentLog_.open(
+        this->checkpointPath_ + ".current.txt", std::ios::app);
+  }
+  if (learner->HasAttribute("checkpoint_interval"))
+  {
+    learner->GetAttribute("checkpoint_interval")->Get(
+        this->checkpointInterval_);
+    this->checkpointInterval_ =
+        std::max(this->checkpointInterval_, static_cast< size_t >(1));
+  }
+  // Racing aborts candidates that cannot enter the ranked policies anymore
+  if (learner->HasAttribute("racing"))
+  {
+    learner->GetAttribute("racing")->Get(this->racing_);
+  }
+  if (learner->HasAttribute("race_confidence"))
+  {
+    learner->GetAttribute("race_confidence")->Get(this->raceConfidence_);
+    if (this->raceConfidence_ < 1)
+    {
+      std::cerr << "`race_confidence` has to be at least 1, a candidate "
+                << "would be aborted before it fell behind." << std::endl;
+      throw std::runtime_error("Robot brain error");
+    }
+  }
+  if (learner->HasAttribute("race_min_time"))
+  {
+    learner->GetAttribute("race_min_time")->Get(this->raceMinTime_);
+  }
+  if (learner->HasAttribute("policy_load_path"))
+  {
+    this->policyLoadPath_ =
+        learner->GetAttribute("policy_load_path")->GetAsString();
+  }
+
   this->algorithmType_ = "D";
   this->evaluationRate_ = 30.0;
   this->numInterpolationPoints_ = 100;
@@ -72,10 +148,20 @@ RLPower::RLPower(
 
   // Generate first random policy
   auto numMotors = _motors.size();
+  this->output_.assign(numMotors, 0);
   this->InitialisePolicy(numMotors);
+  if (not this->policyLoadPath_.empty())
+  {
+    this->LoadPolicy(this->policyLoadPath_);
+  }
 
   // Start the evaluator
   this->evaluator_.reset(new Evaluator(this->evaluationRate_));
+  if (learner->HasAttribute("fitness"))
+  {
+    this->evaluator_->SetMetric(Evaluator::ParseMetric(
+        learner->GetAttribute("fitness")->GetAsString()));
+  }
 }
 
 /////////////////////////////////////////////////
@@ -97,8 +183,9 @@ void RLPower::Update(
 
   auto numMotors = _motors.size();
 
-  // Evaluate policy on certain time limit
-  if ((_time - this->startTime_) > this->evaluationRate_ and
+  // Evaluate policy on certain time limit, or as soon as it is hopeless
+  auto elapsed = _time - this->startTime_;
+  if ((elapsed > this->evaluationRate_ or this->Hopeless(elapsed)) and
       this->generationCounter_ < this->maxEvaluations_)
   {
     this->UpdatePolicy(numMotors);
@@ -107,7 +194,7 @@ void RLPower::Update(
   }
 
   // generate outputs
-  auto *output = new double[numMotors];
+  auto output = this->output_.data();
   this->Output(numMotors, _time, output);
 
   // Send new signals to the actuators
@@ -118,112 +205,73 @@ void RLPower::Update(
     p += motor->Outputs();
   }
 
-  auto currPosition = this->robot_->WorldPose();
-  this->evaluator_->Update(currPosition);
-  delete[] output;
+  auto power = 0.0;
+  for (const auto &motor: _motors)
+  {
+    power += motor->Power();
+  }
+  auto currPosition = this->pose_();
+  this->evaluator_->Update(currPosition, _time, power);
 }
 
 /////////////////////////////////////////////////
 void RLPower::InitialisePolicy(size_t _numSplines)
 {
-  std::random_device rd;
-  std::mt19937 mt(rd());
   std::normal_distribution< double > dist(0, this->sigma_);
 
-  // Init first random controller
-  if (not this->currentPolicy_)
+  // Init of empty archive, or join the archive of the population
+  if (not this->archive_)
   {
-    this->currentPolicy_ = std::make_shared< Policy >(_numSplines);
+    this->archive_ = this->populationKey_.empty()
+                     ? std::make_shared< PolicyArchive >(
+                         this->maxRankedPolicies_,
+                         _numSplines,
+                         this->sourceYSize_)
+                     : PolicyArchive::Shared(
+                         this->populationKey_,
+                         this->maxRankedPolicies_,
+                         _numSplines,
+                         this->sourceYSize_);
   }
 
-  for (size_t i = 0; i < _numSplines; ++i)
+  // A robot joining a population that already learns starts at its
+  // resolution
   {
-    Spline spline(this->sourceYSize_);
-    for (size_t j = 0; j < this->sourceYSize_; ++j)
-    {
-      spline[j] = dist(mt);
-    }
-    this->currentPolicy_->at(i) = spline;
-  }
-
-  // Init of empty cache
-  if (not this->interpolationCache_)
-  {
-    this->interpolationCache_ = std::make_shared< Policy >(_numSplines);
+    boost::mutex::scoped_lock lock(this->archive_->Mutex());
+    this->sourceYSize_ = this->archive_->Points();
   }
+  this->stepRate_ = std::max(
+          static_cast<size_t>(1),
+          this->numInterpolationPoints_ / this->sourceYSize_);
 
-  for (size_t i = 0; i < _numSplines; ++i)
+  // Init first random controller
+  this->currentPolicy_.resize(_numSplines * this->sourceYSize_);
+  for (auto &point : this->currentPolicy_)
   {
-    this->interpolationCache_->at(i).resize(this->numInterpolationPoints_, 0);
+    point = dist(this->rng_);
   }
 
-  this->InterpolateCubic(
-      _numSplines,
-      this->currentPolicy_.get(),
-      this->interpolationCache_.get());
+  this->InterpolateCubic(_numSplines);
 }
 
 /////////////////////////////////////////////////
-void RLPower::InterpolateCubic(
-    const size_t _numSplines,
-    Policy *const _sourceY,
-    Policy *_destinationY)
+void RLPower::InterpolateCubic(const size_t _numSplines)
 {
-  const auto sourceYSize = (*_sourceY)[0].size();
-  const auto destinatioYSize = (*_destinationY)[0].size();
-
-  const auto N = sourceYSize + 1;
-  auto *x = new double[N];
-  auto *y = new double[N];
-  auto *xNew = new double[destinatioYSize];
-
-  auto *acc = gsl_interp_accel_alloc();
-  const auto *t = gsl_interp_cspline_periodic;
-  auto *spline = gsl_spline_alloc(t, N);
-
-  // init x
-  auto step_size = RLPower::CYCLE_LENGTH / sourceYSize;
-  for (size_t i = 0; i < N; ++i)
-  {
-    x[i] = step_size * i;
-  }
-
-  // init xNew
-  step_size = CYCLE_LENGTH / destinatioYSize;
-  for (size_t i = 0; i < destinatioYSize; ++i)
-  {
-    xNew[i] = step_size * i;
-  }
-
+  // Solve all splines of the policy at once
+  this->splinePoints_.resize(this->sourceYSize_ * _numSplines);
   for (size_t j = 0; j < _numSplines; ++j)
   {
-    auto &sourceYLine = _sourceY->at(j);
-    auto &destinationYLine = _destinationY->at(j);
-
-    // init y
-    // TODO use memcpy
-    for (size_t i = 0; i < sourceYSize; ++i)
+    const auto spline = &this->currentPolicy_[j * this->sourceYSize_];
+    for (size_t i = 0; i < this->sourceYSize_; ++i)
     {
-      y[i] = sourceYLine[i];
-    }
-
-    // make last equal to first
-    y[N - 1] = y[0];
-
-    gsl_spline_init(spline, x, y, N);
-
-    for (size_t i = 0; i < destinatioYSize; ++i)
-    {
-      destinationYLine[i] = gsl_spline_eval(spline, xNew[i], acc);
+      this->splinePoints_[i * _numSplines + j] = spline[i];
     }
   }
-
-  gsl_spline_free(spline);
-  gsl_interp_accel_free(acc);
-
-  delete[] xNew;
-  delete[] y;
-  delete[] x;
+  this->policySpline_.Fit(
+      this->splinePoints_.data(),
+      this->sourceYSize_,
+      _numSplines,
+      RLPower::CYCLE_LENGTH);
 }
 
 /////////////////////////////////////////////////
@@ -231,32 +279,41 @@ void RLPower::UpdatePolicy(const size_t _numSplines)
 {
   // Calculate fitness for current policy
   auto currFitness = this->Fitness();
+  this->raceSpeed_ = std::max(
+      this->raceSpeed_, this->evaluator_->Metrics().mean_speed());
 
-  // Insert ranked policy in list
-  PolicyPtr backupPolicy = std::make_shared< Policy >(_numSplines);
-  for (size_t i = 0; i < _numSplines; ++i)
-  {
-    auto &spline = this->currentPolicy_->at(i);
-    backupPolicy->at(i) = Spline(spline.begin(), spline.end());
-
-    spline.resize(this->sourceYSize_);
-  }
-  this->rankedPolicies_.insert({currFitness, backupPolicy});
+  // The archive may be shared with the other robots of a population
+  boost::mutex::scoped_lock lock(this->archive_->Mutex());
 
-  // Remove worst policies
-  while (this->rankedPolicies_.size() > this->maxRankedPolicies_)
+  // Another robot of the population increased the spline points while
+  // this policy was evaluated
+  if (this->archive_->Points() not_eq this->sourceYSize_)
   {
-    auto last = std::prev(this->rankedPolicies_.end());
-    this->rankedPolicies_.erase(last);
+    this->ResamplePolicy(_numSplines, this->archive_->Points());
   }
 
+  // Insert ranked policy in the archive, which drops the worst one when
+  // it is full
+  this->archive_->Insert(currFitness, this->currentPolicy_.data());
+
   // TODO: Record fitnesses and policies
 
-  // Update generation counter and check is it finished
-  this->generationCounter_++;
-  if (this->generationCounter_ == this->maxEvaluations_)
+  // Update generation counter and check is it finished. The counter is the
+  // number of evaluations of the whole population.
+  this->generationCounter_ = this->archive_->Evaluations();
+  if (this->generationCounter_ >= this->maxEvaluations_)
   {
-    std::exit(0);
+    // Keep running the best policy, `Update()` stops learning from here
+    if (this->archive_->Size() > 0)
+    {
+      auto best = this->archive_->Policy(0);
+      std::copy(best, best + this->currentPolicy_.size(),
+                this->currentPolicy_.begin());
+      this->InterpolateCubic(_numSplines);
+    }
+    this->SaveCheckpoint();
+    this->LogBestSplines();
+    return;
   }
 
   // Increase spline points if it is a time
@@ -271,20 +328,17 @@ void RLPower::UpdatePolicy(const size_t _numSplines)
   /// Default, for algorithms A and B, is used standard normal distribution
   /// with decaying sigma. For algorithms C and D, is used normal distribution
   /// with self-adaptive sigma.
-  std::random_device rd;
-  std::mt19937 mt(rd());
-
   if (this->algorithmType_ == "C" or this->algorithmType_ == "D")
   {
     // uncorrelated mutation with one step size
-    std::mt19937 sigma_mt(rd());
     std::normal_distribution< double > sigma_dist(0, 1);
-    this->sigma_ = this->sigma_ * std::exp(this->tau_ * sigma_dist(sigma_mt));
+    this->sigma_ =
+        this->sigma_ * std::exp(this->tau_ * sigma_dist(this->rng_));
   }
   else
   {
     // Default is decaying sigma
-    if (this->rankedPolicies_.size() >= this->maxRankedPolicies_)
+    if (this->archive_->Size() >= this->maxRankedPolicies_)
     {
       this->sigma_ *= SIGMA;
     }
@@ -295,16 +349,13 @@ void RLPower::UpdatePolicy(const size_t _numSplines)
   /// Default, for algorithms A and C, is used ten parent crossover
   /// For algorithms B and D, is used two parent crossover with binary
   /// tournament selection
-  if (this->rankedPolicies_.size() < this->maxRankedPolicies_)
+  if (this->archive_->Size() < this->maxRankedPolicies_)
   {
     // Generate random policy if number of stored policies is less then
     // `maxRankedPolicies_`
-    for (size_t i = 0; i < _numSplines; ++i)
+    for (auto &point : this->currentPolicy_)
     {
-      for (size_t j = 0; j < this->sourceYSize_; ++j)
-      {
-        (*this->currentPolicy_)[i][j] = dist(mt);
-      }
+      point = dist(this->rng_);
     }
   }
   else
@@ -321,11 +372,11 @@ void RLPower::UpdatePolicy(const size_t _numSplines)
         parent2 = this->BinarySelection();
       }
 
-      auto fitness1 = parent1->first;
-      auto fitness2 = parent2->first;
+      auto fitness1 = this->archive_->Fitness(parent1);
+      auto fitness2 = this->archive_->Fitness(parent2);
 
-      auto policy1 = parent1->second;
-      auto policy2 = parent2->second;
+      auto policy1 = this->archive_->Policy(parent1);
+      auto policy2 = this->archive_->Policy(parent2);
 
       // TODO: Verify what should be total fitness in binary
       totalFitness = fitness1 + fitness2;
@@ -337,20 +388,18 @@ void RLPower::UpdatePolicy(const size_t _numSplines)
         for (size_t j = 0; j < this->sourceYSize_; ++j)
         {
           // Apply modifier
+          auto k = i * this->sourceYSize_ + j;
+          auto &current = this->currentPolicy_[k];
           auto splinePoint = 0.0;
-          splinePoint +=
-              ((policy1->at(i)[j] - (*this->currentPolicy_)[i][j])) *
-              (fitness1 / totalFitness);
-          splinePoint +=
-              ((policy2->at(i)[j] - (*this->currentPolicy_)[i][j])) *
-              (fitness2 / totalFitness);
+          splinePoint += (policy1[k] - current) * (fitness1 / totalFitness);
+          splinePoint += (policy2[k] - current) * (fitness2 / totalFitness);
 
           // Add a mutation + current
           // TODO: Verify do we use current in this case
-          splinePoint += dist(mt) + (*this->currentPolicy_)[i][j];
+          splinePoint += dist(this->rng_) + current;
 
           // Set a newly generated point as current
-          (*this->currentPolicy_)[i][j] = splinePoint;
+          current = splinePoint;
         }
       }
     }
@@ -359,10 +408,9 @@ void RLPower::UpdatePolicy(const size_t _numSplines)
       // Default is all parents selection
 
       // Calculate first total sum of fitnesses
-      for (auto const &it : this->rankedPolicies_)
+      for (size_t r = 0; r < this->archive_->Size(); ++r)
       {
-        auto fitness = it.first;
-        totalFitness += fitness;
+        totalFitness += this->archive_->Fitness(r);
       }
 
       // For each spline
@@ -373,99 +421,192 @@ void RLPower::UpdatePolicy(const size_t _numSplines)
         for (size_t j = 0; j < this->sourceYSize_; ++j)
         {
           // Apply modifier
+          auto k = i * this->sourceYSize_ + j;
+          auto &current = this->currentPolicy_[k];
           auto splinePoint = 0.0;
-          for (auto const &it : this->rankedPolicies_)
+          for (size_t r = 0; r < this->archive_->Size(); ++r)
           {
-            auto fitness = it.first;
-            auto policy = it.second;
-
-            splinePoint +=
-                ((policy->at(i)[j] - (*this->currentPolicy_)[i][j])) *
-                (fitness / totalFitness);
+            splinePoint += (this->archive_->Policy(r)[k] - current) *
+                           (this->archive_->Fitness(r) / totalFitness);
           }
 
           // Add a mutation + current
           // TODO: Verify do we use 'current_policy_' in this case
-          splinePoint += dist(mt) + (*this->currentPolicy_)[i][j];
+          splinePoint += dist(this->rng_) + current;
 
           // Set a newly generated point as current
-          (*this->currentPolicy_)[i][j] = splinePoint;
+          current = splinePoint;
         }
       }
     }
   }
 
-  // cache update
-  this->InterpolateCubic(
-      _numSplines,
-      this->currentPolicy_.get(),
-      this->interpolationCache_.get());
+  // Fit the splines of the new policy
+  this->InterpolateCubic(_numSplines);
+  this->UpdateRaceBounds();
+
+  this->LogCurrentSpline();
+  // A checkpoint that failed to save is retried after the next evaluation
+  if (this->generationCounter_ % this->checkpointInterval_ == 0 or
+      (this->checkpointWriter_ and this->checkpointWriter_->Failed()))
+  {
+    this->SaveCheckpoint();
+  }
 }
 
 /////////////////////////////////////////////////
-void RLPower::IncreaseSplinePoints(const size_t _numSplines)
+void RLPower::LoadPolicy(const std::string &_policyPath)
 {
-  this->sourceYSize_++;
+  PolicyCheckpoint::State state;
+  if (not PolicyCheckpoint::Load(_policyPath, state))
+  {
+    std::cout << "No policy checkpoint at `" << _policyPath
+              << "`, learning from scratch." << std::endl;
+    return;
+  }
 
-  // LOG code
+  const auto numSplines = this->output_.size();
+  if (state.splines not_eq numSplines)
+  {
+    std::cerr << "The checkpoint `" << _policyPath << "` has "
+              << state.splines << " splines for " << numSplines
+              << " motors." << std::endl;
+    throw std::runtime_error("Robot brain error");
+  }
+
+  boost::mutex::scoped_lock lock(this->archive_->Mutex());
+
+  // The first robot of a population to resume restores the shared archive
+  if (this->archive_->Evaluations() == 0)
+  {
+    this->archive_->Restore(
+        state.points,
+        state.evaluations,
+        state.fitness.size(),
+        state.fitness.data(),
+        state.policies.data());
+  }
+
+  this->sigma_ = state.sigma;
+  this->generationCounter_ = this->archive_->Evaluations();
+  this->currentPolicy_ = state.current;
+  this->sourceYSize_ = state.points;
   this->stepRate_ = std::max(
           static_cast<size_t>(1),
           this->numInterpolationPoints_ / this->sourceYSize_);
-
-  // Copy current policy for resizing
-  Policy policy_copy(this->currentPolicy_->size());
-  for (size_t i = 0; i < _numSplines; ++i)
+  this->InterpolateCubic(numSplines);
+  if (this->archive_->Points() not_eq this->sourceYSize_)
   {
-    auto &spline = this->currentPolicy_->at(i);
-    policy_copy[i] = Spline(spline.begin(), spline.end());
+    this->ResamplePolicy(numSplines, this->archive_->Points());
+    this->InterpolateCubic(numSplines);
+  }
 
-    spline.resize(this->sourceYSize_);
+  this->UpdateRaceBounds();
+
+  std::cout << "Resumed learning from `" << _policyPath << "` after "
+            << this->generationCounter_ << " evaluations." << std::endl;
+}
+
+/////////////////////////////////////////////////
+bool RLPower::Hopeless(const double _elapsed) const
+{
+  if (not this->racing_ or not this->raceReady_ or
+      this->raceSpeed_ < 0 or _elapsed < this->raceMinTime_)
+  {
+    return false;
   }
 
-  this->InterpolateCubic(0, &policy_copy, this->currentPolicy_.get());
+  // Even if the rest of the evaluation went as well as the selected metric
+  // allows, moving `raceConfidence_` times as fast as the fastest evaluation
+  // so far, the candidate would still rank below the worst ranked policy.
+  // Its fitness now is below the bound, so the full archive rejects it.
+  auto remaining = std::max(this->evaluationRate_ - _elapsed, 0.0);
+  auto optimistic = this->evaluator_->Bound(
+      remaining, this->raceConfidence_ * this->raceSpeed_);
+  return optimistic < this->raceWorst_;
+}
+
+/////////////////////////////////////////////////
+void RLPower::UpdateRaceBounds()
+{
+  this->raceReady_ = this->archive_->Size() >= this->maxRankedPolicies_ and
+                     this->archive_->Size() > 0;
+  if (this->raceReady_)
+  {
+    this->raceWorst_ = this->archive_->Fitness(this->archive_->Size() - 1);
+  }
+}
 
-  for (auto &it : this->rankedPolicies_)
+/////////////////////////////////////////////////
+void RLPower::SaveCheckpoint()
+{
+  if (this->checkpointWriter_)
   {
-    auto policy = it.second;
+    PolicyCheckpoint::Snapshot(
+        this->sigma_,
+        this->currentPolicy_,
+        *this->archive_,
+        this->snapshot_);
+    this->checkpointWriter_->Submit(this->snapshot_);
+  }
+}
+
+/////////////////////////////////////////////////
+void RLPower::ResamplePolicy(
+    const size_t _numSplines,
+    const size_t _points)
+{
+  // The fitted splines of the current policy are sampled directly
+  this->splinePoints_.resize(_points * _numSplines);
+  this->policySpline_.Sample(_points, this->splinePoints_.data());
+
+  this->sourceYSize_ = _points;
+  this->stepRate_ = std::max(
+          static_cast<size_t>(1),
+          this->numInterpolationPoints_ / this->sourceYSize_);
 
-    for (size_t j = 0; j < _numSplines; ++j)
+  this->currentPolicy_.resize(_numSplines * _points);
+  for (size_t j = 0; j < _numSplines; ++j)
+  {
+    for (size_t i = 0; i < _points; ++i)
     {
-      auto &spline = policy->at(j);
-      policy_copy[j] = Spline(spline.begin(), spline.end());
-      spline.resize(this->sourceYSize_);
+      this->currentPolicy_[j * _points + i] =
+          this->splinePoints_[i * _numSplines + j];
     }
-    this->InterpolateCubic(0, &policy_copy, policy.get());
   }
 }
 
 /////////////////////////////////////////////////
-std::map< double, PolicyPtr >::iterator RLPower::BinarySelection()
+void RLPower::IncreaseSplinePoints(const size_t /* _numSplines */)
+{
+  this->sourceYSize_++;
+
+  // LOG code
+  this->stepRate_ = std::max(
+          static_cast<size_t>(1),
+          this->numInterpolationPoints_ / this->sourceYSize_);
+
+  // Resample the current and all ranked policies as one batch of splines
+  this->archive_->Resample(
+      this->sourceYSize_, RLPower::CYCLE_LENGTH, this->currentPolicy_);
+}
+
+/////////////////////////////////////////////////
+size_t RLPower::BinarySelection()
 {
-  std::random_device rd;
-  std::mt19937 umt(rd());
-  std::uniform_int_distribution <size_t> udist(0, this->maxRankedPolicies_ - 1);
+  std::uniform_int_distribution <size_t> udist(0, this->archive_->Size() - 1);
 
-  // Select two different numbers from uniform distribution
-  // U(0, max_ranked_policies_ - 1
+  // Select two different ranks from uniform distribution
+  // U(0, archive size - 1)
   size_t pindex1, pindex2;
-  pindex1 = udist(umt);
+  pindex1 = udist(this->rng_);
   do
   {
-    pindex2 = udist(umt);
+    pindex2 = udist(this->rng_);
   } while (pindex1 == pindex2);
 
-  // Set iterators to begin of the 'ranked_policies_' map
-  auto individual1 = this->rankedPolicies_.begin();
-  auto individual2 = this->rankedPolicies_.begin();
-
-  // Move iterators to indices positions
-  std::advance(individual1, pindex1);
-  std::advance(individual2, pindex2);
-
-  auto fitness1 = individual1->first;
-  auto fitness2 = individual2->first;
-
-  return fitness1 > fitness2 ? individual1 : individual2;
+  // The archive is sorted by descending fitness, so the lower rank wins
+  return std::min(pindex1, pindex2);
 }
 
 // seconds
@@ -486,36 +627,59 @@ void RLPower::Modify(ConstModifyPolicyPtr &/* _request */)
   // TODO: Implement the rest of the method
 }
 
-void RLPower::Output(
-    const size_t _numSplines,
-    const double _time,
-    double *_output)
+void RLPower::LogCurrentSpline()
 {
-  if (this->cycleStartTime_ < 0)
+  if (not this->currentLog_.is_open())
   {
-    this->cycleStartTime_ = _time;
+    return;
   }
 
-  // get correct X value (between 0 and CYCLE_LENGTH)
-  auto x = _time - this->cycleStartTime_;
-  while (x >= RLPower::CYCLE_LENGTH)
+  // One line per generation: the generation and the control points
+  this->currentLog_ << this->generationCounter_;
+  for (const auto point : this->currentPolicy_)
   {
-    this->cycleStartTime_ += RLPower::CYCLE_LENGTH;
-    x = _time - this->cycleStartTime_;
+    this->currentLog_ << ' ' << point;
   }
+  this->currentLog_ << '\n';
+  this->currentLog_.flush();
+}
 
-  // adjust X on the cache coordinate space
-  x = (x / CYCLE_LENGTH) * this->numInterpolationPoints_;
-  // generate previous and next values
-  auto x_a = ((int)x) % this->numInterpolationPoints_;
-  auto x_b = (x_a + 1) % this->numInterpolationPoints_;
+/////////////////////////////////////////////////
+void RLPower::LogBestSplines()
+{
+  if (this->checkpointPath_.empty())
+  {
+    return;
+  }
 
-  // linear interpolation for every actuator
-  for (size_t i = 0; i < _numSplines; ++i)
+  // One line per ranked policy, best first: the fitness and the control
+  // points
+  std::ofstream log(this->checkpointPath_ + ".best.txt", std::ios::trunc);
+  const auto policySize = this->archive_->Splines() * this->archive_->Points();
+  for (size_t r = 0; r < this->archive_->Size(); ++r)
   {
-    auto y_a = this->interpolationCache_->at(i)[x_a];
-    auto y_b = this->interpolationCache_->at(i)[x_b];
+    log << this->archive_->Fitness(r);
+    auto policy = this->archive_->Policy(r);
+    for (size_t k = 0; k < policySize; ++k)
+    {
+      log << ' ' << policy[k];
+    }
+    log << '\n';
+  }
+}
 
-    _output[i] = y_a + ((y_b - y_a) * (x - x_a) / (x_b - x_a));
+/////////////////////////////////////////////////
+void RLPower::Output(
+    const size_t /* _numSplines */,
+    const double _time,
+    double *_output)
+{
+  if (this->cycleStartTime_ < 0)
+  {
+    this->cycleStartTime_ = _time;
   }
+
+  // The spline wraps the time into the cycle and evaluates the cubic of
+  // the current segment for all motors at once
+  this->policySpline_.Evaluate(_time - this->cycleStartTime_, _output);
 }
@@ -22,8 +22,11 @@
 #define REVOLVE_GAZEBO_BRAIN_RLPOWER_H_
 
 #include <cmath>
+#include <fstream>
 #include <functional>
 #include <map>
+#include <memory>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -34,6 +37,10 @@
 
 #include "Evaluator.h"
 #include "Brain.h"
+#include "CheckpointWriter.h"
+#include "PeriodicSpline.h"
+#include "PolicyArchive.h"
+#include "PolicyCheckpoint.h"
 
 namespace revolve
 {
@@ -73,6 +80,18 @@ namespace revolve
           const std::vector< MotorPtr > &_motors,
           const std::vector< SensorPtr > &_sensors);
 
+      /// \brief Constructor for a robot outside of a simulation, which does
+      /// not publish its fitness
+      /// \param[in] _node Brain configuration with the `rv:learner` element
+      /// \param[in] _worldName Name of the world, which scopes the population
+      /// \param[in] _pose Pose of the robot, from which the fitness follows
+      /// \param[in] _motors Motors receiving the outputs
+      public: RLPower(
+          const sdf::ElementPtr &_node,
+          const std::string &_worldName,
+          const PoseSource &_pose,
+          const std::vector< MotorPtr > &_motors);
+
       /// \brief Destructor
       public: ~RLPower() override;
 
@@ -127,30 +146,43 @@ namespace revolve
       /// \brief Evaluate the current policy and generate new
       private: void UpdatePolicy(const size_t _numSplines);
 
-      /// \brief  Load saved policy from JSON file
+      /// \brief Resumes learning from a checkpoint, if the file exists
       private: void LoadPolicy(const std::string &_policyPath);
 
-      /// \brief Generate interpolated spline based on number of sampled control
-      /// points in 'source_y'
-      /// \param[in] _sourceY: set of control points over which interpolation is
-      /// generated
-      /// \param[out] _destinationY: set of interpolated control points
-      /// (default 100)
-      private: void InterpolateCubic(
+      /// \brief Whether racing can abort the current candidate
+      /// \param[in] _elapsed Time since the start of its evaluation
+      private: bool Hopeless(const double _elapsed) const;
+
+      /// \brief Caches the fitness `Hopeless()` compares with from the archive
+      /// \details Expects the mutex of `archive_` to be locked.
+      private: void UpdateRaceBounds();
+
+      /// \brief Hands a snapshot of the learning state to the checkpoint
+      /// writer if a checkpoint path is configured
+      /// \details Expects the mutex of `archive_` to be locked. The file is
+      /// written by the writer thread after the lock is released.
+      private: void SaveCheckpoint();
+
+      /// \brief Fits the splines of the current policy, which `Output()`
+      /// evaluates
+      private: void InterpolateCubic(const size_t _numSplines);
+
+      /// \brief Resamples the current policy to a number of control points
+      /// \param[in] _points New number of control points per spline
+      private: void ResamplePolicy(
           const size_t _numSplines,
-          Policy *const _sourceY,
-          Policy *_destinationY);
+          const size_t _points);
 
       /// \brief Increment number of sampling points for policy
       private: void IncreaseSplinePoints(const size_t _numSplines);
 
       /// \brief Randomly select two policies and return the one with higher
       /// fitness
-      /// \return an iterator from 'ranked_policies_' map
-      private: std::map< double, PolicyPtr >::iterator BinarySelection();
+      /// \return a rank in `archive_`
+      private: size_t BinarySelection();
 
-      /// \brief Extracts the value of the current_policy in x=time using linear
-      /// interpolation
+      /// \brief Evaluates the splines of the current policy at the phase of
+      /// `_time` in the cycle
       /// Writes the output in output_vector
       private: void Output(
           const size_t _numSplines,
@@ -161,17 +193,14 @@ namespace revolve
       /// \return
       private: double Fitness();
 
-      /// \brief Writes current spline to file
+      /// \brief Appends the current policy to `<checkpoint>.current.txt`
       private: void LogCurrentSpline();
 
-      /// \brief Writes best 10 splines to file
+      /// \brief Writes the ranked policies to `<checkpoint>.best.txt`
       private: void LogBestSplines();
 
-      /// \brief Pointer to the current policy
-      private: PolicyPtr currentPolicy_ = NULL;
-
-      /// \brief Pointer to the interpolated current_policy_ (default 100)
-      private: PolicyPtr interpolationCache_ = NULL;
+      /// \brief Control points of the current policy, spline after spline
+      private: std::vector< double > currentPolicy_;
 
       /// \brief Pointer to the fitness evaluator
       private: EvaluatorPtr evaluator_ = NULL;
@@ -179,7 +208,8 @@ namespace revolve
       /// \brief Number of current generation
       private: size_t generationCounter_;
 
-      /// \brief Number of 'interpolation_cache_' sample points
+      /// \brief Reference number of samples per cycle, from which the number
+      /// of generations between two spline point increases follows
       private: size_t numInterpolationPoints_;
 
       /// \brief Maximal number of stored ranked policies
@@ -212,18 +242,80 @@ namespace revolve
       /// \brief
       private: double startTime_;
 
-      /// \brief Name of the robot
-      private: ::gazebo::physics::ModelPtr robot_;
+      /// \brief Pose of the robot for the evaluator
+      private: PoseSource pose_;
 
       /// \brief Type of the used algorithm
       private: std::string algorithmType_;
 
-      /// \brief Load path for previously saved policies
+      /// \brief Checkpoint to resume from, the `policy_load_path` attribute
+      /// of `rv:learner` or else the checkpoint path
       private: std::string policyLoadPath_;
 
-      /// \brief Container for best ranked policies
-      private: std::map< double, PolicyPtr, std::greater< double>>
-          rankedPolicies_;
+      /// \brief Checkpoint file, from the `checkpoint` attribute of
+      /// `rv:learner`, empty to disable checkpoints
+      private: std::string checkpointPath_;
+
+      /// \brief Number of evaluations between two checkpoints, from the
+      /// `checkpoint_interval` attribute of `rv:learner`
+      private: size_t checkpointInterval_;
+
+      /// \brief Writes the checkpoints off the update thread, null without
+      /// a checkpoint path
+      private: CheckpointWriterPtr checkpointWriter_;
+
+      /// \brief Learning state handed to `checkpointWriter_`, whose buffers
+      /// are reused from one checkpoint to the next
+      private: PolicyCheckpoint::State snapshot_;
+
+      /// \brief `<checkpoint>.current.txt`, open while checkpoints are
+      /// enabled
+      private: std::ofstream currentLog_;
+
+      /// \brief Whether hopeless candidates are aborted early, from the
+      /// `racing` attribute of `rv:learner`
+      private: bool racing_;
+
+      /// \brief Margin on `raceSpeed_`, at least 1: a candidate is credited
+      /// with `raceConfidence_` times the fastest mean speed so far for the
+      /// rest of its evaluation before it is aborted (`race_confidence`)
+      private: double raceConfidence_;
+
+      /// \brief Time every candidate runs before it can be aborted
+      /// (`race_min_time`)
+      private: double raceMinTime_;
+
+      /// \brief Whether the archive is full, so that a candidate has to
+      /// beat its worst policy
+      private: bool raceReady_;
+
+      /// \brief Fastest mean speed of all evaluations of this robot,
+      /// negative before the first one ended
+      private: double raceSpeed_;
+
+      /// \brief Fitness of the worst ranked policy
+      private: double raceWorst_;
+
+      /// \brief Motor outputs of the current step, allocated once
+      private: std::vector< double > output_;
+
+      /// \brief Splines of the current policy, as the polynomial
+      /// coefficients of every segment
+      private: PeriodicSpline policySpline_;
+
+      /// \brief Control points of the current policy, point-major
+      private: std::vector< double > splinePoints_;
+
+      /// \brief Random number engine for the policies and the selection,
+      /// seeded once per brain
+      private: std::mt19937 rng_;
+
+      /// \brief Best ranked policies, shared by all robots of a population
+      private: std::shared_ptr< PolicyArchive > archive_;
+
+      /// \brief World and name of the population, from the `population`
+      /// attribute of `rv:learner`, empty for a robot learning alone
+      private: std::string populationKey_;
     };
   }
 }
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Compressed sparse row (CSR) matrix used to store the
+ *              connection weights of a neural network brain.
+ * Date: October 16, 2026
+ *
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "SparseMatrix.h"
+
+using namespace revolve::gazebo;
+
+/////////////////////////////////////////////////
+SparseMatrix::SparseMatrix(
+    const unsigned int _rows,
+    const unsigned int _columns)
+    : rows_(_rows)
+    , cols_(_columns)
+    , offsets_(_rows + 1, 0)
+{
+}
+
+/////////////////////////////////////////////////
+SparseMatrix SparseMatrix::FromTriplets(
+    const unsigned int _rows,
+    const unsigned int _columns,
+    std::vector< Triplet > _triplets)
+{
+  // Stable sort keeps the insertion order of duplicates so that the last
+  // one can be picked below.
+  std::stable_sort(
+      _triplets.begin(),
+      _triplets.end(),
+      [](const Triplet &_a, const Triplet &_b)
+      {
+        return _a.row < _b.row or (_a.row == _b.row and _a.column < _b.column);
+      });
+
+  SparseMatrix matrix(_rows, _columns);
+  matrix.columns_.reserve(_triplets.size());
+  matrix.values_.reserve(_triplets.size());
+
+  for (size_t i = 0; i < _triplets.size(); ++i)
+  {
+    const auto &entry = _triplets[i];
+    assert(entry.row < _rows and entry.column < _columns);
+
+    // Skip all but the last of the duplicate entries
+    if (i + 1 < _triplets.size() and
+        _triplets[i + 1].row == entry.row and
+        _triplets[i + 1].column == entry.column)
+    {
+      continue;
+    }
+    if (std::fpclassify(entry.value) == FP_ZERO)
+    {
+      continue;
+    }
+
+    matrix.columns_.push_back(entry.column);
+    matrix.values_.push_back(entry.value);
+    ++matrix.offsets_[entry.row + 1];
+  }
+
+  // Turn the per-row counts into offsets
+  for (unsigned int row = 0; row < _rows; ++row)
+  {
+    matrix.offsets_[row + 1] += matrix.offsets_[row];
+  }
+
+  return matrix;
+}
+
+/////////////////////////////////////////////////
+void SparseMatrix::Multiply(
+    const double *_x,
+    double *_y) const
+{
+  for (unsigned int row = 0; row < this->rows_; ++row)
+  {
+    _y[row] = this->RowDot(row, _x);
+  }
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Compressed sparse row (CSR) matrix used to store the
+ *              connection weights of a neural network brain.
+ * Date: October 16, 2026
+ *
+ */
+
+#ifndef REVOLVE_GAZEBO_BRAIN_SPARSEMATRIX_H_
+#define REVOLVE_GAZEBO_BRAIN_SPARSEMATRIX_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace revolve
+{
+  namespace gazebo
+  {
+    /// \brief Row-major sparse matrix in compressed sparse row format.
+    /// \details Rows are target neurons and columns are source neurons, so a
+    /// row holds all incoming connections of one neuron. Entries within a row
+    /// are kept sorted by column. A matrix is built once from triplets by
+    /// `FromTriplets()` and is immutable afterwards, so a network edit builds
+    /// a new one from the neuron keys. The hot path only ever reads
+    /// `Offsets()`, `Columns()` and `Values()`.
+    class SparseMatrix
+    {
+      /// \brief A single (row, column, value) entry used for bulk building
+      public: struct Triplet
+      {
+        unsigned int row;
+        unsigned int column;
+        double value;
+      };
+
+      /// \brief Constructor
+      /// \param[in] _rows Number of rows
+      /// \param[in] _columns Number of columns
+      public: SparseMatrix(
+          const unsigned int _rows = 0,
+          const unsigned int _columns = 0);
+
+      /// \brief Builds a matrix from a list of entries. When an entry appears
+      /// more than once, the last value wins. Zero values are not stored.
+      /// \param[in] _rows Number of rows
+      /// \param[in] _columns Number of columns
+      /// \param[in] _triplets The entries
+      public: static SparseMatrix FromTriplets(
+          const unsigned int _rows,
+          const unsigned int _columns,
+          std::vector< Triplet > _triplets);
+
+      /// \brief Computes `_y = A * _x`
+      /// \param[in] _x Input vector of `Cols()` elements
+      /// \param[out] _y Output vector of `Rows()` elements
+      public: void Multiply(
+          const double *_x,
+          double *_y) const;
+
+      /// \return Dot product of a single row with `_x`
+      public: inline double RowDot(
+          const unsigned int _row,
+          const double *_x) const
+      {
+        double sum = 0;
+        for (auto k = this->offsets_[_row]; k < this->offsets_[_row + 1]; ++k)
+        {
+          sum += this->values_[k] * _x[this->columns_[k]];
+        }
+        return sum;
+      }
+
+      /// \return Number of rows
+      public: unsigned int Rows() const { return this->rows_; }
+
+      /// \return Number of columns
+      public: unsigned int Cols() const { return this->cols_; }
+
+      /// \return Number of stored (non-zero) entries
+      public: size_t NonZeros() const { return this->values_.size(); }
+
+      /// \return Row start offsets, `Rows() + 1` elements
+      public: const std::vector< unsigned int > &Offsets() const
+      {
+        return this->offsets_;
+      }
+
+      /// \return Column index of each stored entry
+      public: const std::vector< unsigned int > &Columns() const
+      {
+        return this->columns_;
+      }
+
+      /// \return Value of each stored entry
+      public: const std::vector< double > &Values() const
+      {
+        return this->values_;
+      }
+
+      /// \brief Number of rows
+      private: unsigned int rows_;
+
+      /// \brief Number of columns
+      private: unsigned int cols_;
+
+      /// \brief Start of each row in `columns_` and `values_`
+      private: std::vector< unsigned int > offsets_;
+
+      /// \brief Column index of each entry
+      private: std::vector< unsigned int > columns_;
+
+      /// \brief Value of each entry
+      private: std::vector< double > values_;
+    };
+  }
+}
+
+#endif  // REVOLVE_GAZEBO_BRAIN_SPARSEMATRIX_H_
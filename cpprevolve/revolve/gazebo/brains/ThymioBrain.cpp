@@ -33,8 +33,10 @@ using namespace revolve::gazebo;
 ThymioBrain::ThymioBrain(
     ::gazebo::physics::ModelPtr _model,
     sdf::ElementPtr /* _node */,
-    std::vector< MotorPtr > &/* _motors */,
+    std::vector< MotorPtr > &_motors,
     std::vector< SensorPtr > &/* _sensors */)
+    : output_(_motors.size(), 0)
+    , rng_(std::random_device()())
 {
   std::cout << "Hello!" << std::endl;
   this->robot_ = _model;
@@ -49,19 +51,15 @@ void ThymioBrain::Update(
     double /* _time */,
     double _step)
 {
-  std::random_device rd;
-  std::mt19937 mt(rd());
   std::normal_distribution< double > dist(0, 1);
 
   auto numMotors = _motors.size();
-  auto *output = new double[numMotors];
+  auto output = this->output_.data();
   for (size_t i = 0; i < numMotors; ++i)
   {
-    output[i] += std::abs(dist(mt));
+    output[i] = std::abs(dist(this->rng_));
   }
 
-  std::cout << "Output: " << output[0] << std::endl;
-
   // Send new signals to the actuators
   auto p = 0;
   for (const auto &motor: _motors)
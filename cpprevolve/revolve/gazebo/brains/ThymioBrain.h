@@ -22,6 +22,9 @@
 #ifndef REVOLVE_THYMIOBRAIN_H
 #define REVOLVE_THYMIOBRAIN_H
 
+#include <random>
+#include <vector>
+
 #include "Brain.h"
 
 
@@ -62,6 +65,12 @@ namespace revolve
 
       /// \brief Name of the robot
       private: ::gazebo::physics::ModelPtr robot_;
+
+      /// \brief Motor outputs of the current step, allocated once
+      private: std::vector< double > output_;
+
+      /// \brief Random number engine, seeded once per brain
+      private: std::mt19937 rng_;
     };
   }
 }
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Records neuron states into a ring buffer that a background
+ *              thread writes to a binary columnar file.
+ * Date: October 16, 2026
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include "TraceRecorder.h"
+
+using namespace revolve::gazebo;
+
+const unsigned int TraceRecorder::FLUSH_INTERVAL_MS;
+
+/////////////////////////////////////////////////
+TraceRecorder::TraceRecorder(
+    const std::string &_path,
+    const size_t _capacity)
+    : path_(_path)
+    , file_(_path, std::ios::binary | std::ios::trunc)
+    , capacity_(std::max(_capacity, static_cast< size_t >(1)))
+    , head_(0)
+    , tail_(0)
+    , dropped_(0)
+    , running_(true)
+{
+  if (not this->file_)
+  {
+    std::cerr << "Cannot open the trace file `" << _path << "`."
+              << std::endl;
+    throw std::runtime_error("Robot brain error");
+  }
+  this->file_.write("RVTRACE1", 8);
+
+  this->ring_.assign(this->capacity_, 0);
+  this->thread_ = std::thread(&TraceRecorder::Run, this);
+}
+
+/////////////////////////////////////////////////
+TraceRecorder::~TraceRecorder()
+{
+  this->running_ = false;
+  this->thread_.join();
+
+  this->Collect();
+  for (const auto &block : this->pending_)
+  {
+    this->Write(block);
+  }
+
+  if (this->Dropped() > 0)
+  {
+    std::cerr << "Dropped " << this->Dropped() << " rows of the trace `"
+              << this->path_ << "`, the ring buffer was full. Increase "
+              << "`trace_capacity` to keep them." << std::endl;
+  }
+}
+
+/////////////////////////////////////////////////
+void TraceRecorder::SetColumns(const std::vector< std::string > &_names)
+{
+  boost::mutex::scoped_lock lock(this->mutex_);
+
+  this->Collect();
+  this->names_ = _names;
+  this->ring_.assign(this->capacity_ * (1 + _names.size()), 0);
+  this->head_ = 0;
+  this->tail_ = 0;
+}
+
+/////////////////////////////////////////////////
+void TraceRecorder::Record(
+    const double _time,
+    const double *_values)
+{
+  // Only this function and `SetColumns()`, which runs on the same thread,
+  // write the head, so only the tail can move concurrently.
+  auto head = this->head_.load(std::memory_order_relaxed);
+  auto tail = this->tail_.load(std::memory_order_acquire);
+  if (head - tail >= this->capacity_)
+  {
+    this->dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  const auto width = 1 + this->names_.size();
+  auto row = &this->ring_[(head % this->capacity_) * width];
+  row[0] = _time;
+  std::memcpy(row + 1, _values, this->names_.size() * sizeof(double));
+  this->head_.store(head + 1, std::memory_order_release);
+}
+
+/////////////////////////////////////////////////
+void TraceRecorder::Run()
+{
+  std::vector< Block > blocks;
+  while (this->running_)
+  {
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(FLUSH_INTERVAL_MS));
+
+    {
+      boost::mutex::scoped_lock lock(this->mutex_);
+      this->Collect();
+      blocks.swap(this->pending_);
+    }
+
+    // The file is only written without the lock, so the update thread
+    // never waits for the disk.
+    for (const auto &block : blocks)
+    {
+      this->Write(block);
+    }
+    blocks.clear();
+    this->file_.flush();
+  }
+}
+
+/////////////////////////////////////////////////
+void TraceRecorder::Collect()
+{
+  auto head = this->head_.load(std::memory_order_acquire);
+  auto tail = this->tail_.load(std::memory_order_relaxed);
+  if (head == tail)
+  {
+    return;
+  }
+
+  if (this->pending_.empty() or this->pending_.back().names not_eq
+                                this->names_)
+  {
+    this->pending_.push_back({this->names_, {}});
+  }
+
+  const auto width = 1 + this->names_.size();
+  auto &rows = this->pending_.back().rows;
+  for (auto i = tail; i < head; ++i)
+  {
+    auto row = this->ring_.begin() + (i % this->capacity_) * width;
+    rows.insert(rows.end(), row, row + width);
+  }
+  this->tail_.store(head, std::memory_order_release);
+}
+
+/////////////////////////////////////////////////
+void TraceRecorder::Write(const Block &_block)
+{
+  // Write 32 and 16 bit integers byte by byte, so the file is little
+  // endian on every host. Doubles are assumed to be IEEE 754 little endian.
+  auto writeInteger = [this](uint32_t _value, const unsigned int _bytes)
+  {
+    for (unsigned int i = 0; i < _bytes; ++i)
+    {
+      this->file_.put(static_cast< char >((_value >> (8 * i)) & 0xff));
+    }
+  };
+
+  const auto width = 1 + _block.names.size();
+  const auto nRows = _block.rows.size() / width;
+  writeInteger(static_cast< uint32_t >(width), 4);
+  writeInteger(static_cast< uint32_t >(nRows), 4);
+
+  writeInteger(4, 2);
+  this->file_.write("time", 4);
+  for (const auto &name : _block.names)
+  {
+    writeInteger(static_cast< uint32_t >(name.size()), 2);
+    this->file_.write(name.data(), name.size());
+  }
+
+  // Transpose the rows into columns
+  std::vector< double > column(nRows);
+  for (size_t c = 0; c < width; ++c)
+  {
+    for (size_t r = 0; r < nRows; ++r)
+    {
+      column[r] = _block.rows[r * width + c];
+    }
+    this->file_.write(
+        reinterpret_cast< const char * >(column.data()),
+        nRows * sizeof(double));
+  }
+}
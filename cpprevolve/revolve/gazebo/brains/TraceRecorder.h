@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Records neuron states into a ring buffer that a background
+ *              thread writes to a binary columnar file.
+ * Date: October 16, 2026
+ *
+ */
+
+#ifndef REVOLVE_GAZEBO_BRAIN_TRACERECORDER_H_
+#define REVOLVE_GAZEBO_BRAIN_TRACERECORDER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+namespace revolve
+{
+  namespace gazebo
+  {
+    class TraceRecorder;
+
+    typedef std::unique_ptr< TraceRecorder > TraceRecorderPtr;
+
+    /// \brief Opt-in recorder of the neuron states of a brain.
+    /// \details `Record()` copies one row (the time and every column) into a
+    /// preallocated ring buffer and never allocates, locks or writes. A
+    /// background thread moves the rows out every `FLUSH_INTERVAL_MS`
+    /// milliseconds and appends them to the file. Rows that arrive while
+    /// the ring is full are dropped, and their number is logged when the
+    /// recorder stops.
+    ///
+    /// The file starts with the magic `RVTRACE1`, followed by blocks of
+    ///
+    ///     uint32 columns, uint32 rows,
+    ///     columns x (uint16 length, name bytes),
+    ///     columns x rows doubles, column after column
+    ///
+    /// in little endian, with `time` as the first column. Every block names
+    /// its columns, so the columns may change between blocks when the
+    /// network is modified. `tools/trace_reader.py` converts a trace to CSV
+    /// or numpy, skipping a last block that was cut short.
+    class TraceRecorder
+    {
+      /// \brief Time between two writes of the background thread
+      public: static const unsigned int FLUSH_INTERVAL_MS = 50;
+
+      /// \brief Constructor, opens the file and starts the writer thread
+      /// \param[in] _path File to create
+      /// \param[in] _capacity Number of rows of the ring buffer
+      public: TraceRecorder(
+          const std::string &_path,
+          const size_t _capacity);
+
+      /// \brief Destructor, writes the remaining rows, closes the file and
+      /// logs the dropped rows
+      public: ~TraceRecorder();
+
+      /// \brief Sets the names of the columns of the following rows
+      /// \details Rows recorded so far are set aside with the previous
+      /// names. This may allocate and wait for the writer to finish moving
+      /// rows, so it belongs with the network modifications rather than the
+      /// update.
+      public: void SetColumns(const std::vector< std::string > &_names);
+
+      /// \brief Appends a row
+      /// \param[in] _time Time of the row
+      /// \param[in] _values One value per column
+      public: void Record(
+          const double _time,
+          const double *_values);
+
+      /// \return Number of rows dropped because the ring was full
+      public: uint64_t Dropped() const { return this->dropped_; }
+
+      /// \brief Rows sharing the same columns, waiting to be written
+      private: struct Block
+      {
+        std::vector< std::string > names;
+
+        /// \brief Row-major values, the time first in every row
+        std::vector< double > rows;
+      };
+
+      /// \brief Body of the writer thread
+      private: void Run();
+
+      /// \brief Moves the rows out of the ring into a block with the
+      /// current columns, with `mutex_` locked
+      private: void Collect();
+
+      /// \brief Appends a block to the file
+      private: void Write(const Block &_block);
+
+      /// \brief Path of the output file
+      private: std::string path_;
+
+      /// \brief Output file, only used by the writer thread and the
+      /// destructor
+      private: std::ofstream file_;
+
+      /// \brief Number of rows of the ring
+      private: size_t capacity_;
+
+      /// \brief Names of the current columns, without the time
+      private: std::vector< std::string > names_;
+
+      /// \brief Ring of `capacity_` rows of `1 + names_.size()` values
+      private: std::vector< double > ring_;
+
+      /// \brief Number of rows ever recorded since the ring was last reset,
+      /// written by `Record()` only
+      private: std::atomic< uint64_t > head_;
+
+      /// \brief Number of rows ever collected since the ring was last reset,
+      /// written with `mutex_` locked only
+      private: std::atomic< uint64_t > tail_;
+
+      /// \brief Rows dropped because the ring was full
+      private: std::atomic< uint64_t > dropped_;
+
+      /// \brief Collected blocks not written yet
+      private: std::vector< Block > pending_;
+
+      /// \brief Protects `names_`, the size of `ring_`, `tail_` and
+      /// `pending_`
+      private: boost::mutex mutex_;
+
+      /// \brief Cleared to stop the writer thread
+      private: std::atomic< bool > running_;
+
+      /// \brief Writer thread
+      private: std::thread thread_;
+    };
+  }
+}
+
+#endif  // REVOLVE_GAZEBO_BRAIN_TRACERECORDER_H_
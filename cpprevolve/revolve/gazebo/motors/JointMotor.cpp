@@ -17,6 +17,7 @@
 *
 */
 
+#include <cmath>
 #include <string>
 
 #include <revolve/gazebo/motors/JointMotor.h>
@@ -53,3 +54,11 @@ JointMotor::JointMotor(
 
 /////////////////////////////////////////////////
 JointMotor::~JointMotor() = default;
+
+/////////////////////////////////////////////////
+double JointMotor::Power()
+{
+  auto wrench = this->joint_->GetForceTorque(0);
+  auto torque = wrench.body2Torque.Dot(this->joint_->LocalAxis(0));
+  return std::fabs(torque * this->joint_->GetVelocity(0));
+}
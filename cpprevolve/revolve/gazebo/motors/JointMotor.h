@@ -47,6 +47,11 @@ namespace revolve
       /// \brief Destructor
       public: virtual ~JointMotor();
 
+      /// \brief Torque about the joint axis times the joint velocity
+      /// \details Gazebo only measures the torque of joints with
+      /// `<provide_feedback>` enabled, the power of others is zero.
+      public: double Power() override;
+
       /// \brief The joint this motor is controlling
       protected: ::gazebo::physics::JointPtr joint_;
 
@@ -53,6 +53,12 @@ unsigned int Motor::Outputs()
   return this->outputs_;
 }
 
+/////////////////////////////////////////////////
+double Motor::Power()
+{
+  return 0;
+}
+
 /////////////////////////////////////////////////
 gz::common::PID Motor::CreatePid(sdf::ElementPtr _sdfPID)
 {
@@ -68,6 +68,10 @@ namespace revolve
       /// \return Number of output neurons connected to this motor
       public: unsigned int Outputs();
 
+      /// \return Mechanical power the motor currently delivers, zero if it
+      /// cannot be measured
+      public: virtual double Power();
+
       /// \brief Create PID element
       /// \param pid Pointer to the rv:pid element
       /// \return Gazebo PID
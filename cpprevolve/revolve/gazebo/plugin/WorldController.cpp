@@ -35,7 +35,7 @@ WorldController::WorldController()
 /////////////////////////////////////////////////
 void WorldController::Load(
     gz::physics::WorldPtr world,
-    sdf::ElementPtr /*_sdf*/)
+    sdf::ElementPtr _sdf)
 {
   std::cout << "World plugin loaded." << std::endl;
 
@@ -80,6 +80,20 @@ void WorldController::Load(
   // Robot pose publisher
   this->robotStatesPub_ = this->node_->Advertise< revolve::msgs::RobotStates >(
       "~/revolve/robot_states", 50);
+
+  // Evaluate the neural networks of robots sharing a layout in batches.
+  // This has to happen before robots are inserted, since their brains look
+  // up the pool when they are loaded.
+  if (_sdf and _sdf->HasElement("rv:batch_brains") and
+      _sdf->GetElement("rv:batch_brains")->Get< bool >())
+  {
+    this->brainPool_ = BrainPool::Create(world);
+  }
+  if (_sdf and _sdf->HasElement("rv:batch_cpgs") and
+      _sdf->GetElement("rv:batch_cpgs")->Get< bool >())
+  {
+    this->cpgBank_ = CPGBank::Create(world);
+  }
 }
 
 /////////////////////////////////////////////////
@@ -37,6 +37,9 @@
 #include <revolve/msgs/model_inserted.pb.h>
 #include <revolve/msgs/robot_states.pb.h>
 
+#include <revolve/gazebo/brains/BrainPool.h>
+#include <revolve/gazebo/brains/CPGBank.h>
+
 namespace revolve
 {
   namespace gazebo
@@ -109,6 +112,14 @@ namespace revolve
 
       // Last (simulation) time robot info was sent
       double lastRobotStatesUpdateTime_;
+
+      // Batched evaluator for the robot brains, only set when enabled with
+      // the `rv:batch_brains` element
+      BrainPoolPtr brainPool_;
+
+      // Batched integrator for the differential CPGs, only set when enabled
+      // with the `rv:batch_cpgs` element
+      CPGBankPtr cpgBank_;
     };
   }  // namespace gazebo
 }  // namespace revolve
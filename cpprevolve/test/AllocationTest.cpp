@@ -0,0 +1,609 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Checks that the brains do not allocate memory in their
+ *              control loop once they are warmed up. The steps that end an
+ *              evaluation learn and may allocate, so they are not counted.
+ *              ThymioBrain is not covered, its constructor needs a model of
+ *              a running simulation. Neither is a NeuralNetwork evaluated in
+ *              a BrainPool, which only a world plugin creates.
+ * Date: October 16, 2026
+ *
+ */
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <revolve/gazebo/brains/CPGBank.h>
+#include <revolve/gazebo/brains/DifferentialCPG.h>
+#include <revolve/gazebo/brains/Evaluator.h>
+#include <revolve/gazebo/brains/LimitCycle.h>
+#include <revolve/gazebo/brains/NeuralNetwork.h>
+#include <revolve/gazebo/brains/PeriodicSpline.h>
+#include <revolve/gazebo/brains/RLPower.h>
+#include <revolve/gazebo/motors/Motor.h>
+#include <revolve/gazebo/sensors/VirtualSensor.h>
+
+using namespace revolve::gazebo;
+
+/// Steps taken before counting, so that every buffer reached its size
+static const unsigned int WARM_UP_STEPS = 1000;
+
+/// Steps over which no allocation may happen
+static const unsigned int COUNTED_STEPS = 10000;
+
+/// Actuation time of a step in seconds
+static const double STEP = 0.005;
+
+/// Whether the replaced allocation functions count
+static std::atomic< bool > counting(false);
+
+/// Allocations while counting
+static std::atomic< size_t > allocations(0);
+
+/// Deallocations while counting
+static std::atomic< size_t > deallocations(0);
+
+/////////////////////////////////////////////////
+void *operator new(size_t _size)
+{
+  if (counting)
+  {
+    ++allocations;
+  }
+  if (auto pointer = std::malloc(_size > 0 ? _size : 1))
+  {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+
+/////////////////////////////////////////////////
+void *operator new[](size_t _size)
+{
+  return ::operator new(_size);
+}
+
+/////////////////////////////////////////////////
+void operator delete(void *_pointer) noexcept
+{
+  if (counting and _pointer)
+  {
+    ++deallocations;
+  }
+  std::free(_pointer);
+}
+
+/////////////////////////////////////////////////
+void operator delete[](void *_pointer) noexcept
+{
+  ::operator delete(_pointer);
+}
+
+/////////////////////////////////////////////////
+void operator delete(void *_pointer, size_t /* _size */) noexcept
+{
+  ::operator delete(_pointer);
+}
+
+/////////////////////////////////////////////////
+void operator delete[](void *_pointer, size_t /* _size */) noexcept
+{
+  ::operator delete(_pointer);
+}
+
+/// \brief Motor that keeps its last outputs
+class RecordingMotor
+    : public Motor
+{
+  /// \brief Constructor
+  public: RecordingMotor(
+      const std::string &_partId,
+      const unsigned int _outputs)
+      : Motor(::gazebo::physics::ModelPtr(), _partId, "motor", _outputs)
+      , sum_(0)
+  {
+  }
+
+  /// \brief Accumulates the outputs
+  public: void Update(
+      double *_output,
+      double /* _step */) override
+  {
+    for (unsigned int i = 0; i < this->Outputs(); ++i)
+    {
+      this->sum_ += _output[i];
+    }
+  }
+
+  /// \brief Sum of all outputs, so the steps cannot be optimised away
+  public: double sum_;
+};
+
+/// \brief Sensor reading a slowly changing signal
+class WaveSensor
+    : public VirtualSensor
+{
+  /// \brief Constructor
+  public: WaveSensor(
+      const std::string &_partId,
+      const unsigned int _inputs)
+      : VirtualSensor(::gazebo::physics::ModelPtr(), _partId, "sensor",
+                      _inputs)
+      , phase_(0)
+  {
+  }
+
+  /// \brief Writes one sine per input
+  public: void Read(double *_input) override
+  {
+    this->phase_ += 0.01;
+    for (unsigned int i = 0; i < this->Inputs(); ++i)
+    {
+      _input[i] = std::sin(this->phase_ + i);
+    }
+  }
+
+  /// \brief Phase of the signal
+  private: double phase_;
+};
+
+/// \brief Runs a step function before and while counting allocations
+/// \return False if the counted steps allocated or freed memory
+/////////////////////////////////////////////////
+template< typename StepFunction >
+bool CheckSteps(
+    const std::string &_name,
+    StepFunction &&_step)
+{
+  for (unsigned int i = 0; i < WARM_UP_STEPS; ++i)
+  {
+    _step();
+  }
+
+  allocations = 0;
+  deallocations = 0;
+  counting = true;
+  for (unsigned int i = 0; i < COUNTED_STEPS; ++i)
+  {
+    _step();
+  }
+  counting = false;
+
+  auto passed = allocations == 0 and deallocations == 0;
+  std::cout << (passed ? "[PASS] " : "[FAIL] ") << _name << ": "
+            << allocations << " allocations and " << deallocations
+            << " deallocations over " << COUNTED_STEPS << " steps"
+            << std::endl;
+  return passed;
+}
+
+/// \brief Runs a step without counting its allocations
+/////////////////////////////////////////////////
+template< typename StepFunction >
+void Uncounted(StepFunction &&_step)
+{
+  auto previous = counting.exchange(false);
+  _step();
+  counting = previous;
+}
+
+/// \brief Tells which steps end an evaluation, the same way the learning
+/// brains do
+class EvaluationClock
+{
+  /// \brief Constructor
+  /// \param[in] _rate Duration of an evaluation
+  public: explicit EvaluationClock(const double _rate)
+      : rate_(_rate)
+      , start_(-1)
+  {
+  }
+
+  /// \return Whether the step at `_time` ends an evaluation
+  public: bool Ends(const double _time)
+  {
+    if (this->start_ < 0)
+    {
+      this->start_ = _time;
+      return false;
+    }
+    if (_time - this->start_ > this->rate_)
+    {
+      this->start_ = _time;
+      return true;
+    }
+    return false;
+  }
+
+  /// \brief Duration of an evaluation
+  private: double rate_;
+
+  /// \brief Start of the current evaluation, negative before the first
+  private: double start_;
+};
+
+/// \brief Creates an SDF element with string attributes
+/////////////////////////////////////////////////
+sdf::ElementPtr Element(
+    const std::string &_name,
+    const std::vector< std::pair< std::string, std::string > > &_attributes)
+{
+  sdf::ElementPtr element(new sdf::Element);
+  element->SetName(_name);
+  for (const auto &attribute : _attributes)
+  {
+    element->AddAttribute(attribute.first, "string", attribute.second, false);
+  }
+  return element;
+}
+
+/// \brief Appends a child to an SDF element
+/// \return The child
+/////////////////////////////////////////////////
+sdf::ElementPtr Insert(
+    const sdf::ElementPtr &_parent,
+    const sdf::ElementPtr &_child)
+{
+  _child->SetParent(_parent);
+  _parent->InsertElement(_child);
+  return _child;
+}
+
+/// \brief Adds a neuron to a network description
+/////////////////////////////////////////////////
+void AddNeuron(
+    revolve::msgs::NeuralNetwork &_network,
+    const std::string &_id,
+    const std::string &_layer,
+    const std::string &_type,
+    const std::vector< double > &_params)
+{
+  auto neuron = _network.add_neuron();
+  neuron->set_id(_id);
+  neuron->set_layer(_layer);
+  neuron->set_type(_type);
+  neuron->set_partid("body");
+  for (const auto value : _params)
+  {
+    neuron->add_param()->set_value(value);
+  }
+}
+
+/// \brief Adds a connection to a network description
+/////////////////////////////////////////////////
+void AddConnection(
+    revolve::msgs::NeuralNetwork &_network,
+    const std::string &_src,
+    const std::string &_dst,
+    const double _weight)
+{
+  auto connection = _network.add_connection();
+  connection->set_src(_src);
+  connection->set_dst(_dst);
+  connection->set_weight(_weight);
+}
+
+/// \brief Steps a network with every neuron type through `Update()`
+/// \param[in] _cyclic Whether the outputs feed back into the hidden neurons
+/////////////////////////////////////////////////
+bool CheckNeuralNetwork(const bool _cyclic)
+{
+  revolve::msgs::NeuralNetwork network;
+  AddNeuron(network, "in0", "input", "Input", {});
+  AddNeuron(network, "in1", "input", "Input", {});
+  AddNeuron(network, "sigmoid", "hidden", "Sigmoid", {0.1, 1.0});
+  AddNeuron(network, "simple", "hidden", "Simple", {0.0, 0.5});
+  AddNeuron(network, "ctrnn", "hidden", "CTRNN_Sigmoid", {0.2, 0.05, 1.0});
+  AddNeuron(network, "out0", "output", "Oscillator", {0.5, 0.0, 1.0});
+  AddNeuron(network, "out1", "output", "SUPG", {1.0, 0.25, 1.0});
+  AddNeuron(network, "out2", "output", "Sigmoid", {0.0, 1.0});
+  AddConnection(network, "in0", "sigmoid", 0.7);
+  AddConnection(network, "in1", "simple", -0.4);
+  AddConnection(network, "in1", "ctrnn", 0.3);
+  AddConnection(network, "sigmoid", "out2", 0.9);
+  AddConnection(network, "simple", "out2", -0.6);
+  AddConnection(network, "ctrnn", "out1", 0.5);
+  if (_cyclic)
+  {
+    AddConnection(network, "out2", "sigmoid", 0.2);
+    AddConnection(network, "ctrnn", "ctrnn", -0.3);
+  }
+
+  std::vector< MotorPtr > motors = {
+      std::make_shared< RecordingMotor >("body", 3)};
+  std::vector< SensorPtr > sensors = {
+      std::make_shared< WaveSensor >("body", 2)};
+  NeuralNetwork brain(network, motors, sensors);
+
+  auto time = 0.0;
+  return CheckSteps(
+      _cyclic ? "NeuralNetwork::Update (cyclic)"
+              : "NeuralNetwork::Update (acyclic)",
+      [&]()
+      {
+        time += STEP;
+        brain.Update(motors, sensors, time, STEP);
+      });
+}
+
+/// \brief Integrates a ring of coupled oscillators with every scheme
+/////////////////////////////////////////////////
+bool CheckDifferentialCPG()
+{
+  // Pairs of x and y neurons, every pair coupled to the next one
+  const size_t pairs = 8;
+  const size_t neurons = 2 * pairs;
+  std::vector< size_t > incoming(neurons + 1, 0);
+  std::vector< size_t > sources;
+  std::vector< double > weights;
+  for (size_t n = 0; n < neurons; ++n)
+  {
+    auto partner = n % 2 == 0 ? n + 1 : n - 1;
+    sources.push_back(partner);
+    weights.push_back(n % 2 == 0 ? 1.0 : -1.0);
+    if (n % 2 == 0)
+    {
+      sources.push_back((n + 2) % neurons);
+      weights.push_back(0.5);
+    }
+    incoming[n + 1] = sources.size();
+  }
+  std::vector< double > bias(neurons, 0);
+  std::vector< double > step(neurons, STEP / 4);
+
+  auto passed = true;
+  for (const auto &name : {"euler", "rk4", "semi_implicit"})
+  {
+    auto integrator = DifferentialCPG::ParseIntegrator(name);
+
+    std::vector< double > state(neurons, 0);
+    std::vector< double > rates(4 * neurons, 0);
+    std::vector< double > stage(neurons, 0);
+    for (size_t n = 0; n < neurons; n += 2)
+    {
+      state[n] = 1;
+    }
+
+    CPGArrays cpg;
+    cpg.neurons = neurons;
+    cpg.incoming = incoming.data();
+    cpg.sources = sources.data();
+    cpg.weights = weights.data();
+    cpg.bias = bias.data();
+    cpg.step = step.data();
+    cpg.state = state.data();
+    cpg.rates = rates.data();
+    cpg.stage = stage.data();
+
+    passed = CheckSteps(
+        std::string("DifferentialCPG::Integrate (") + name + ")",
+        [&]()
+        {
+          DifferentialCPG::Integrate(integrator, 4, cpg);
+        }) and passed;
+  }
+  return passed;
+}
+
+/// \brief Steps a differential CPG through `Update()` while it learns its
+/// weights, recording its outputs until they converge
+/// \param[in] _banked Whether a bank integrates the CPG
+/////////////////////////////////////////////////
+bool CheckDifferentialCPGUpdate(const bool _banked)
+{
+  // Strong weights and short evaluations, so the oscillators complete
+  // several cycles per evaluation and none is longer than the recording
+  // buffers that `LimitCycle` reserves
+  const auto rate = 2.5;
+  auto settings = Element("rv:robot_config", {});
+  auto brain = Insert(settings, Element("rv:brain", {}));
+  Insert(brain, Element("rv:controller", {{"integrator", "rk4"}}));
+  Insert(brain, Element("rv:learner", {
+      {"evaluation_rate", std::to_string(rate)},
+      {"init_samples", "3"},
+      {"weight_min", "-20"},
+      {"weight_max", "20"}}));
+
+  std::vector< MotorPtr > motors;
+  for (int x = 0; x < 4; ++x)
+  {
+    auto part = "motor" + std::to_string(x);
+    Insert(settings, Element("rv:motor", {
+        {"part_id", part},
+        {"x", std::to_string(x)},
+        {"y", "0"}}));
+    motors.push_back(std::make_shared< RecordingMotor >(part, 1));
+  }
+  std::vector< SensorPtr > sensors;
+
+  auto time = 0.0;
+  auto bank = _banked ? std::make_shared< CPGBank >("allocation_test")
+                      : CPGBankPtr();
+  DifferentialCPG cpg(
+      settings,
+      bank,
+      [&time]()
+      {
+        return ignition::math::Pose3d(time, 0.1 * time, 0, 0, 0, 0);
+      },
+      motors,
+      sensors);
+
+  EvaluationClock clock(rate);
+  auto update = [&]()
+  {
+    cpg.Update(motors, sensors, time, STEP);
+    if (bank)
+    {
+      // The world update end
+      bank->Flush();
+    }
+  };
+  return CheckSteps(
+      _banked ? "DifferentialCPG::Update (banked)"
+              : "DifferentialCPG::Update",
+      [&]()
+      {
+        time += STEP;
+        if (clock.Ends(time))
+        {
+          Uncounted(update);
+        }
+        else
+        {
+          update();
+        }
+      });
+}
+
+/// \brief Replays a converged sine
+/////////////////////////////////////////////////
+bool CheckLimitCycle()
+{
+  const size_t outputs = 4;
+  LimitCycle cycle(outputs, 0.02);
+  std::vector< double > values(outputs);
+
+  auto time = 0.0;
+  while (not cycle.Converged())
+  {
+    time += STEP;
+    for (size_t o = 0; o < outputs; ++o)
+    {
+      values[o] = std::sin(2 * M_PI * time + o);
+    }
+    cycle.Record(STEP, values.data());
+  }
+
+  return CheckSteps(
+      "LimitCycle::Replay",
+      [&]()
+      {
+        cycle.Replay(STEP, values.data());
+      });
+}
+
+/// \brief Evaluates the splines of an RLPower policy
+/////////////////////////////////////////////////
+bool CheckPeriodicSpline()
+{
+  const size_t points = 20;
+  const size_t splines = 8;
+  std::mt19937 rng(42);
+  std::uniform_real_distribution< double > distribution(-1, 1);
+  std::vector< double > y(points * splines);
+  for (auto &value : y)
+  {
+    value = distribution(rng);
+  }
+
+  PeriodicSpline spline;
+  spline.Fit(y.data(), points, splines, 1.0);
+  std::vector< double > out(splines);
+
+  auto x = 0.0;
+  return CheckSteps(
+      "PeriodicSpline::Evaluate",
+      [&]()
+      {
+        x += STEP;
+        spline.Evaluate(x, out.data());
+      });
+}
+
+/// \brief Steps RLPower through `Update()` while it learns its policy
+/////////////////////////////////////////////////
+bool CheckRLPower()
+{
+  auto brain = Element("rv:brain", {});
+  Insert(brain, Element("rv:learner", {}));
+
+  std::vector< MotorPtr > motors = {
+      std::make_shared< RecordingMotor >("left", 1),
+      std::make_shared< RecordingMotor >("right", 1)};
+  std::vector< SensorPtr > sensors;
+
+  auto time = 0.0;
+  RLPower rlpower(
+      brain,
+      "allocation_test",
+      [&time]()
+      {
+        return ignition::math::Pose3d(time, 0.1 * time, 0, 0, 0, 0);
+      },
+      motors);
+
+  // Evaluations last 30 seconds, which RLPower does not read from SDF
+  EvaluationClock clock(30);
+  auto update = [&]()
+  {
+    rlpower.Update(motors, sensors, time, STEP);
+  };
+  return CheckSteps(
+      "RLPower::Update",
+      [&]()
+      {
+        time += STEP;
+        if (clock.Ends(time))
+        {
+          Uncounted(update);
+        }
+        else
+        {
+          update();
+        }
+      });
+}
+
+/// \brief Feeds poses to an evaluator
+/////////////////////////////////////////////////
+bool CheckEvaluator()
+{
+  Evaluator evaluator(30);
+  auto time = 0.0;
+  return CheckSteps(
+      "Evaluator::Update",
+      [&]()
+      {
+        time += STEP;
+        evaluator.Update(
+            ignition::math::Pose3d(time, 0.1 * time, 0, 0, 0, 0.5 * time),
+            time,
+            1.0);
+      });
+}
+
+/////////////////////////////////////////////////
+int main()
+{
+  auto passed = CheckNeuralNetwork(false);
+  passed = CheckNeuralNetwork(true) and passed;
+  passed = CheckDifferentialCPG() and passed;
+  passed = CheckDifferentialCPGUpdate(false) and passed;
+  passed = CheckDifferentialCPGUpdate(true) and passed;
+  passed = CheckLimitCycle() and passed;
+  passed = CheckPeriodicSpline() and passed;
+  passed = CheckRLPower() and passed;
+  passed = CheckEvaluator() and passed;
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2015-2018 Vrije Universiteit Amsterdam
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Description: Compares the batched periodic splines with the periodic
+ *              cubic splines of GSL they replace.
+ * Date: October 16, 2026
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <gsl/gsl_spline.h>
+
+#include <revolve/gazebo/brains/PeriodicSpline.h>
+
+using namespace revolve::gazebo;
+
+/// Largest absolute difference allowed between both implementations
+static const double TOLERANCE = 1e-12;
+
+/// Positions evaluated per period
+static const size_t GRID = 4096;
+
+/// Splines fitted per batch
+static const size_t SPLINES = 5;
+
+/// \brief Fits random control points with both implementations and
+/// evaluates them on a dense grid over two periods
+/// \return Largest absolute difference
+/////////////////////////////////////////////////
+double Compare(
+    const size_t _points,
+    const double _period,
+    std::mt19937 &_rng)
+{
+  std::uniform_real_distribution< double > distribution(-1, 1);
+  std::vector< double > y(_points * SPLINES);
+  for (auto &value : y)
+  {
+    value = distribution(_rng);
+  }
+
+  PeriodicSpline batch;
+  batch.Fit(y.data(), _points, SPLINES, _period);
+
+  // GSL expects the first point repeated at the end of the period
+  const auto N = _points + 1;
+  std::vector< double > x(N);
+  std::vector< double > line(N);
+  for (size_t i = 0; i < N; ++i)
+  {
+    x[i] = _period * i / _points;
+  }
+  x[N - 1] = _period;
+
+  auto acc = gsl_interp_accel_alloc();
+  std::vector< gsl_spline * > splines(SPLINES);
+  for (size_t s = 0; s < SPLINES; ++s)
+  {
+    for (size_t i = 0; i < _points; ++i)
+    {
+      line[i] = y[i * SPLINES + s];
+    }
+    line[N - 1] = line[0];
+    splines[s] = gsl_spline_alloc(gsl_interp_cspline_periodic, N);
+    gsl_spline_init(splines[s], x.data(), line.data(), N);
+  }
+
+  // The second period checks the wrapping of the position
+  auto error = 0.0;
+  std::vector< double > out(SPLINES);
+  for (size_t k = 0; k < 2 * GRID; ++k)
+  {
+    auto position = _period * k / GRID;
+    batch.Evaluate(position, out.data());
+    auto wrapped = std::fmod(position, _period);
+    for (size_t s = 0; s < SPLINES; ++s)
+    {
+      auto expected = gsl_spline_eval(splines[s], wrapped, acc);
+      error = std::max(error, std::fabs(out[s] - expected));
+    }
+  }
+
+  for (auto spline : splines)
+  {
+    gsl_spline_free(spline);
+  }
+  gsl_interp_accel_free(acc);
+  return error;
+}
+
+/////////////////////////////////////////////////
+int main()
+{
+  std::mt19937 rng(42);
+  auto passed = true;
+  for (const auto points : {2, 3, 4, 5, 8, 13, 100})
+  {
+    for (const auto period : {1.0, 2.5})
+    {
+      auto error = Compare(points, period, rng);
+      auto agrees = error <= TOLERANCE;
+      std::cout << (agrees ? "[PASS] " : "[FAIL] ") << points
+                << " points, period " << period << ": largest difference "
+                << error << std::endl;
+      passed = passed and agrees;
+    }
+  }
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
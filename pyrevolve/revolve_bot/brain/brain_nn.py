@@ -1,9 +1,11 @@
 """
 Class containing the brain parts to compose a robot
 """
+import base64
 import xml.etree.ElementTree
 from collections import OrderedDict
 import pyrevolve.SDF
+from pyrevolve.spec.msgs import neural_net_pb2
 from .base import Brain
 
 
@@ -85,6 +87,9 @@ class BrainNN(Brain):
             if self.params[node].gain is not None:
                 yaml_dict_params[node]['gain'] = self.params[node].gain
                 
+            if self.params[node].tau is not None:
+                yaml_dict_params[node]['tau'] = self.params[node].tau
+                
             if self.params[node].period is not None:
                 yaml_dict_params[node]['period'] = self.params[node].period
                 
@@ -102,8 +107,43 @@ class BrainNN(Brain):
         #TODO this is selecting the controller not the learner!
         return xml.etree.ElementTree.Element('rv:learner', {'type': 'offline'})
 
-    def controller_sdf(self):
+    def to_network_message(self):
+        """
+        :return: the network as a `revolve.msgs.NeuralNetwork` message
+        """
+        network = neural_net_pb2.NeuralNetwork()
+        for name, node in self.nodes.items():
+            neuron = network.neuron.add()
+            neuron.id = node.id
+            neuron.layer = node.layer
+            neuron.type = node.type
+            if node.part_id is not None:
+                neuron.partId = node.part_id
+            # Input neurons take no params, like in `networkFromSdf()`
+            if node.layer == 'input':
+                continue
+            params = self.params.get(name, Params())
+            for value in params.values(node.id, node.type):
+                neuron.param.add().value = value
+
+        for connection in self.connections:
+            network.connection.add(src=str(connection.src),
+                                   dst=str(connection.dst),
+                                   weight=connection.weight)
+        return network
+
+    def controller_sdf(self, embed_network=False):
+        """
+        :param embed_network: embed the network as a base64 encoded protobuf
+        message instead of individual neuron and connection elements, which
+        is much faster to load for large brains
+        """
         controller = xml.etree.ElementTree.Element('rv:controller', {'type': 'ann'})
+        if embed_network:
+            payload = self.to_network_message().SerializeToString()
+            pyrevolve.SDF.sub_element_text(controller, 'rv:network', base64.b64encode(payload).decode('ascii'))
+            return controller
+
         node_map = {}
 
         for name, node in self.nodes.items():
@@ -163,6 +203,7 @@ class Params:
         self.amplitude = None
         self.bias = None
         self.gain = None
+        self.tau = None
 
     def load_yaml(self, yaml_object_node):
         if 'period' in yaml_object_node:
@@ -175,6 +216,32 @@ class Params:
             self.bias = yaml_object_node['bias']
         if 'gain' in yaml_object_node:
             self.gain = yaml_object_node['gain']
+        if 'tau' in yaml_object_node:
+            self.tau = yaml_object_node['tau']
+
+    # Names of the params of each neuron type, in the order the robot
+    # controller expects their values
+    NAMES = {
+        'Oscillator': ('period', 'phase_offset', 'amplitude'),
+        'Sigmoid': ('bias', 'gain'),
+        'Simple': ('bias', 'gain'),
+        'CTRNN_Sigmoid': ('bias', 'tau', 'gain'),
+        'SUPG': ('period', 'phase_offset', 'gain'),
+    }
+
+    def values(self, neuron_id, neuron_type):
+        """
+        :param neuron_id: id of the neuron, for the error message
+        :param neuron_type: type of the neuron
+        :return: the parameter values in the order the robot controller expects them for a neuron type
+        :raises ValueError: if a parameter the type requires is not set
+        """
+        names = self.NAMES.get(neuron_type, ())
+        for name in names:
+            if getattr(self, name) is None:
+                raise ValueError("Neuron `{}` of type `{}` is missing the `{}` parameter, it requires {}."
+                                 .format(neuron_id, neuron_type, name, ', '.join('`{}`'.format(n) for n in names)))
+        return [getattr(self, name) for name in names]
 
     def to_sdf(self, node_elem):
         if self.period is not None:
@@ -187,3 +254,5 @@ class Params:
             pyrevolve.SDF.sub_element_text(node_elem, 'rv:bias', self.bias)
         if self.gain is not None:
             pyrevolve.SDF.sub_element_text(node_elem, 'rv:gain', self.gain)
+        if self.tau is not None:
+            pyrevolve.SDF.sub_element_text(node_elem, 'rv:tau', self.tau)
@@ -5,17 +5,46 @@ from .base import Brain
 class BrainRLPowerSplines(Brain):
     TYPE = 'rlpower-splines'
 
+    def __init__(self, population=None, racing=False, fitness=None):
+        """
+        :param population: robots with the same population name in a world share their
+        ranked policies and each evaluate a different candidate at the same time
+        :param racing: abort the evaluation of a candidate as soon as it cannot enter
+        the ranked policies anymore
+        :param fitness: metric the robot optimises, one of `displacement` (default),
+        `path_length`, `speed`, `heading`, `energy` or `upright`
+        """
+        self.population = population
+        self.racing = racing
+        self.fitness = fitness
+
     @staticmethod
     def from_yaml(yaml_object):
-        return BrainRLPowerSplines()
+        return BrainRLPowerSplines(population=yaml_object.get('population', None),
+                                   racing=yaml_object.get('racing', False),
+                                   fitness=yaml_object.get('fitness', None))
 
     def to_yaml(self):
-        return {
+        yaml = {
             'type': self.TYPE
         }
+        if self.population is not None:
+            yaml['population'] = self.population
+        if self.racing:
+            yaml['racing'] = True
+        if self.fitness is not None:
+            yaml['fitness'] = self.fitness
+        return yaml
 
     def learner_sdf(self):
-        return xml.etree.ElementTree.Element('rv:learner', {'type': 'rlpower'})
+        attributes = {'type': 'rlpower'}
+        if self.population is not None:
+            attributes['population'] = str(self.population)
+        if self.racing:
+            attributes['racing'] = 'true'
+        if self.fitness is not None:
+            attributes['fitness'] = str(self.fitness)
+        return xml.etree.ElementTree.Element('rv:learner', attributes)
 
     def controller_sdf(self):
         return xml.etree.ElementTree.Element('rv:controller', {'type': 'spline'})
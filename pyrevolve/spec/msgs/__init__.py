@@ -5,3 +5,4 @@ from .neural_net_pb2 import *
 from .sdf_body_analyze_pb2 import *
 from .model_inserted_pb2 import *
 from .robot_states_pb2 import *
+from .fitness_pb2 import *
@@ -0,0 +1,140 @@
+# Generated by the protocol buffer compiler.  DO NOT EDIT!
+# source: fitness.proto
+
+import sys
+_b=sys.version_info[0]<3 and (lambda x:x) or (lambda x:x.encode('latin1'))
+from google.protobuf import descriptor as _descriptor
+from google.protobuf import message as _message
+from google.protobuf import reflection as _reflection
+from google.protobuf import symbol_database as _symbol_database
+# @@protoc_insertion_point(imports)
+
+_sym_db = _symbol_database.Default()
+
+
+from pygazebo.msg import time_pb2 as time__pb2
+
+
+DESCRIPTOR = _descriptor.FileDescriptor(
+  name='fitness.proto',
+  package='revolve.msgs',
+  syntax='proto2',
+  serialized_pb=_b('\n\rfitness.proto\x12\x0crevolve.msgs\x1a\ntime.proto\"\xeb\x01\n\x07\x46itness\x12\r\n\x05robot\x18\x01 \x02(\t\x12\x1f\n\x04time\x18\x02 \x02(\x0b\x32\x11.gazebo.msgs.Time\x12\x0e\n\x06metric\x18\x03 \x02(\t\x12\x0f\n\x07\x66itness\x18\x04 \x02(\x01\x12\x10\n\x08\x64uration\x18\x05 \x02(\x01\x12\x14\n\x0c\x64isplacement\x18\x06 \x02(\x01\x12\x13\n\x0bpath_length\x18\x07 \x02(\x01\x12\x12\n\nmean_speed\x18\x08 \x02(\x01\x12\x18\n\x10heading_variance\x18\t \x02(\x01\x12\x0e\n\x06\x65nergy\x18\n \x02(\x01\x12\x14\n\x0ctime_upright\x18\x0b \x02(\x01')
+  ,
+  dependencies=[time__pb2.DESCRIPTOR,])
+
+
+
+
+_FITNESS = _descriptor.Descriptor(
+  name='Fitness',
+  full_name='revolve.msgs.Fitness',
+  filename=None,
+  file=DESCRIPTOR,
+  containing_type=None,
+  fields=[
+    _descriptor.FieldDescriptor(
+      name='robot', full_name='revolve.msgs.Fitness.robot', index=0,
+      number=1, type=9, cpp_type=9, label=2,
+      has_default_value=False, default_value=_b("").decode('utf-8'),
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      ),
+    _descriptor.FieldDescriptor(
+      name='time', full_name='revolve.msgs.Fitness.time', index=1,
+      number=2, type=11, cpp_type=10, label=2,
+      has_default_value=False, default_value=None,
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      ),
+    _descriptor.FieldDescriptor(
+      name='metric', full_name='revolve.msgs.Fitness.metric', index=2,
+      number=3, type=9, cpp_type=9, label=2,
+      has_default_value=False, default_value=_b("").decode('utf-8'),
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      ),
+    _descriptor.FieldDescriptor(
+      name='fitness', full_name='revolve.msgs.Fitness.fitness', index=3,
+      number=4, type=1, cpp_type=5, label=2,
+      has_default_value=False, default_value=float(0),
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      ),
+    _descriptor.FieldDescriptor(
+      name='duration', full_name='revolve.msgs.Fitness.duration', index=4,
+      number=5, type=1, cpp_type=5, label=2,
+      has_default_value=False, default_value=float(0),
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      ),
+    _descriptor.FieldDescriptor(
+      name='displacement', full_name='revolve.msgs.Fitness.displacement', index=5,
+      number=6, type=1, cpp_type=5, label=2,
+      has_default_value=False, default_value=float(0),
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      ),
+    _descriptor.FieldDescriptor(
+      name='path_length', full_name='revolve.msgs.Fitness.path_length', index=6,
+      number=7, type=1, cpp_type=5, label=2,
+      has_default_value=False, default_value=float(0),
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      ),
+    _descriptor.FieldDescriptor(
+      name='mean_speed', full_name='revolve.msgs.Fitness.mean_speed', index=7,
+      number=8, type=1, cpp_type=5, label=2,
+      has_default_value=False, default_value=float(0),
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      ),
+    _descriptor.FieldDescriptor(
+      name='heading_variance', full_name='revolve.msgs.Fitness.heading_variance', index=8,
+      number=9, type=1, cpp_type=5, label=2,
+      has_default_value=False, default_value=float(0),
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      ),
+    _descriptor.FieldDescriptor(
+      name='energy', full_name='revolve.msgs.Fitness.energy', index=9,
+      number=10, type=1, cpp_type=5, label=2,
+      has_default_value=False, default_value=float(0),
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      ),
+    _descriptor.FieldDescriptor(
+      name='time_upright', full_name='revolve.msgs.Fitness.time_upright', index=10,
+      number=11, type=1, cpp_type=5, label=2,
+      has_default_value=False, default_value=float(0),
+      message_type=None, enum_type=None, containing_type=None,
+      is_extension=False, extension_scope=None,
+      ),
+  ],
+  extensions=[
+  ],
+  nested_types=[],
+  enum_types=[
+  ],
+  is_extendable=False,
+  syntax='proto2',
+  extension_ranges=[],
+  oneofs=[
+  ],
+  serialized_start=44,
+  serialized_end=279,
+)
+
+_FITNESS.fields_by_name['time'].message_type = time__pb2._TIME
+DESCRIPTOR.message_types_by_name['Fitness'] = _FITNESS
+_sym_db.RegisterFileDescriptor(DESCRIPTOR)
+
+Fitness = _reflection.GeneratedProtocolMessageType('Fitness', (_message.Message,), dict(
+  DESCRIPTOR = _FITNESS,
+  __module__ = 'fitness_pb2'
+  # @@protoc_insertion_point(class_scope:revolve.msgs.Fitness)
+  ))
+_sym_db.RegisterMessage(Fitness)
+
+
+# @@protoc_insertion_point(module_scope)
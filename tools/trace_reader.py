@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""
+Converts a neuron trace written by the `trace` option of the neural network
+brain (`<trace>/<robot name>.rvtrace`) to CSV or numpy.
+
+    tools/trace_reader.py robot.rvtrace robot.csv
+    tools/trace_reader.py robot.rvtrace robot.npz
+
+Columns that only exist in part of the trace, because the network was
+modified while recording, are empty (CSV) or NaN (numpy) elsewhere.
+"""
+
+import argparse
+import csv
+import struct
+import sys
+
+MAGIC = b'RVTRACE1'
+
+
+class TruncatedBlock(Exception):
+    """
+    Raised when the file ends inside a block, as it does when the simulator
+    was killed while writing.
+    """
+
+
+def read_block(data, offset):
+    """
+    :param data: trace file contents
+    :param offset: start of the block
+    :return: (column names, columns) and the offset of the next block
+    """
+    def take(size):
+        if offset + size > len(data):
+            raise TruncatedBlock()
+        return offset + size
+
+    end = take(8)
+    n_columns, n_rows = struct.unpack_from('<II', data, offset)
+    offset = end
+
+    names = []
+    for _ in range(n_columns):
+        end = take(2)
+        length, = struct.unpack_from('<H', data, offset)
+        offset = end
+        end = take(length)
+        names.append(data[offset:end].decode('utf-8'))
+        offset = end
+
+    columns = []
+    for _ in range(n_columns):
+        end = take(8 * n_rows)
+        columns.append(struct.unpack_from('<{}d'.format(n_rows), data, offset))
+        offset = end
+    return (names, columns), offset
+
+
+def read_blocks(path):
+    """
+    :param path: trace file
+    :return: list of (column names, columns) tuples, one per block. A last
+    block that was cut short is skipped with a warning.
+    """
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    if data[:len(MAGIC)] != MAGIC:
+        raise ValueError("{} is not a neuron trace".format(path))
+
+    blocks = []
+    offset = len(MAGIC)
+    while offset < len(data):
+        try:
+            block, offset = read_block(data, offset)
+        except TruncatedBlock:
+            sys.stderr.write("{}: skipped the truncated block at byte {}\n"
+                             .format(path, offset))
+            break
+        blocks.append(block)
+    return blocks
+
+
+def merge(blocks):
+    """
+    :return: the names of all columns in order of appearance and the rows,
+    with None for the columns missing from a block
+    """
+    names = []
+    for block_names, _ in blocks:
+        names += [name for name in block_names if name not in names]
+
+    rows = []
+    for block_names, columns in blocks:
+        index = [block_names.index(name) if name in block_names else None
+                 for name in names]
+        n_rows = len(columns[0]) if columns else 0
+        for r in range(n_rows):
+            rows.append([columns[i][r] if i is not None else None for i in index])
+    return names, rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Converts a neuron trace to CSV or numpy.")
+    parser.add_argument('trace', help="trace file")
+    parser.add_argument('output', help="output file, `.npz` for numpy, CSV otherwise")
+    args = parser.parse_args()
+
+    names, rows = merge(read_blocks(args.trace))
+
+    if args.output.endswith('.npz'):
+        import numpy as np
+        values = np.array([[float('nan') if v is None else v for v in row] for row in rows],
+                          dtype=np.float64).reshape(len(rows), len(names))
+        np.savez(args.output, **{name: values[:, i] for i, name in enumerate(names)})
+    else:
+        with open(args.output, 'w', newline='') as f:
+            writer = csv.writer(f)
+            writer.writerow(names)
+            for row in rows:
+                writer.writerow(['' if v is None else repr(v) for v in row])
+
+    sys.stderr.write("{} rows, {} columns\n".format(len(rows), len(names)))
+
+
+if __name__ == '__main__':
+    main()